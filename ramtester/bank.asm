@@ -0,0 +1,58 @@
+;-------------------------------------------------------------------------------
+;
+;   Author: Ivo Filot <ivo@ivofilot.nl>
+;
+;   P2000T-RAMTESTER is free software:
+;   you can redistribute it and/or modify it under the terms of the
+;   GNU General Public License as published by the Free Software
+;   Foundation, either version 3 of the License, or (at your option)
+;   any later version.
+;
+;   P2000T-RAMTESTER software is distributed in the hope that it will
+;   be useful, but WITHOUT ANY WARRANTY; without even the implied
+;   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+;   See the GNU General Public License for more details.
+;
+;   You should have received a copy of the GNU General Public License
+;   along with this program.  If not, see http://www.gnu.org/licenses/.
+;
+;-------------------------------------------------------------------------------
+
+SECTION code_user
+
+PUBLIC _bank_select
+PUBLIC _current_bank
+
+;-------------------------------------------------------------------------------
+; void bank_select(bankaddr_t bank) __z88dk_fastcall;
+;
+; Write the bank registers without touching the screen; the low byte of the
+; bank address is written to port 0x94 and the high byte to port 0x95. Port
+; 0x95 is only written when its value changes; as count_banks() and main.c
+; select bank addresses of 0x100 and up only on a board with 256 banks,
+; boards without this register never see a write to it beyond the initial
+; one selecting bank 0.
+; The selected bank is kept in current_bank such that the status line can be
+; rendered afterwards.
+;-------------------------------------------------------------------------------
+_bank_select:
+    ld a,l
+    out (0x94),a                ; write bank register
+    ld (_current_bank),hl
+    ld a,h
+    ld hl,bank_hi
+    cp (hl)
+    ret z                       ; high bank register is unchanged
+    ld (hl),a
+    out (0x95),a                ; write high bank register
+    ret
+
+SECTION data_user
+
+bank_hi:
+    defb 0xFF                   ; force write of port 0x95 on first call
+
+SECTION bss_user
+
+_current_bank:
+    defs 2
@@ -27,18 +27,21 @@ static const uint16_t sentinels[NR_SENTINELS] = {
     0xE000, 0xF000
 };
 
-
 /**
- * Construct unique identifier byte
+ * Construct unique identifier byte; the high byte of the selector is folded
+ * into a different bit for every sentinel such that the pair of tags remains
+ * unique for selectors beyond 256.
  */
-uint8_t tag_byte(uint8_t selector, uint8_t idx) {
-    return (uint8_t)((0x5Au + 0x13u * idx) ^ selector);
+uint8_t tag_byte(bankaddr_t selector, uint8_t idx) {
+    uint8_t hi = (uint8_t)(selector >> 8);
+    uint8_t fold = (idx & 0x01) ? (uint8_t)(hi << 7) : (uint8_t)(hi << 6);
+    return (uint8_t)((0x5Au + 0x13u * idx) ^ (uint8_t)selector ^ fold);
 }
 
 /**
  * Write signature to sentinel addresses on bank identified by selector
  */
-void write_signature(uint8_t selector) {
+void write_signature(bankaddr_t selector) {
     for (uint8_t i = 0; i < NR_SENTINELS; ++i) {
         volatile uint8_t *p = (volatile uint8_t *)(sentinels[i]);
         uint8_t t = tag_byte(selector, i);
@@ -50,7 +53,7 @@ void write_signature(uint8_t selector) {
 /**
  * Checks for all sentinel addresses whether the value is correctly returned
  */
-uint8_t verify_signature(uint8_t selector) {
+uint8_t verify_signature(bankaddr_t selector) {
     for (uint8_t i = 0; i < NR_SENTINELS; ++i) {
         volatile uint8_t *p = (volatile uint8_t *)(sentinels[i]);
         uint8_t t  = tag_byte(selector, i);
@@ -63,70 +66,47 @@ uint8_t verify_signature(uint8_t selector) {
 }
 
 /**
- * Count the number of banks by writing a tag value to sentinel addresses. Next,
- * all other banks are screened for aliasing. If an alias is encountered, this means
- * that we have 'wrapped around' in the bank bits and thus no new banks are found.
- * This function performs early exit.
+ * Perform both sweeps over the selectors below limit and return the number
+ * of banks found
  */
-uint16_t count_banks(void) {
-    static uint8_t reps[MAX_SELECTORS];   // avoid stack use
-    uint16_t repcnt = 0;
-
-    set_bank(0); // start from a known bank
-
-    // loop over potential banks
-    for (uint16_t s = 0; s < MAX_SELECTORS; ++s) {
-        uint8_t alias  = FALSE;
-        uint8_t shadow = FALSE;
-
-        // start by pre-scrubbing
-        for (uint8_t i = 0; i < NR_SENTINELS; ++i) {
-            uint16_t eaddr = sentinels[i];                // E000 or F000
-            uint16_t off   = (uint16_t)(eaddr - 0xE000);  // 0 or 0x1000
+static uint16_t count_selectors(uint16_t limit) {
+    uint16_t nrbanks = 0;
 
-            volatile uint8_t *e = (volatile uint8_t *)eaddr;
-            volatile uint8_t *a = (volatile uint8_t *)(0xA000 + off);
-            volatile uint8_t *c = (volatile uint8_t *)(0xC000 + off);
-
-            uint8_t t  = tag_byte((uint8_t)s, i);
-            *a = (uint8_t)~t;
-            *c = (uint8_t)~t;
-        }
+    // write signatures, lowest selector last
+    for (uint16_t s = limit; s-- > 0; ) {
+        bank_select(s);
+        write_signature(s);
+    }
 
-        // Select and tag this candidate
-        set_bank((uint8_t)s);
-        write_signature((uint8_t)s);
+    // read back signatures in ascending order
+    for (uint16_t s = 0; s < limit; ++s) {
+        bank_select(s);
 
         #ifdef DEBUG
-        sprintf(termbuffer, "Testing selector %3u...", (unsigned)s);
-        terminal_printtermbuffer();
+        terminal_beginline();
+        fmt_str("Testing selector ");
+        fmt_dec(s, 3);
+        fmt_str("...");
+        terminal_newline();
         #endif
 
+        if (!verify_signature(s)) {
+            #ifdef DEBUG
+            print_info(" -> ALIAS or no bank; early exit", 0);
+            #endif
+            break; // banks are sequential; first alias means no more banks
+        }
+
         // Shadow check: E000 <-> A000/C000 and F000 <-> B000/D000
+        uint8_t shadow = FALSE;
         for (uint8_t i = 0; i < NR_SENTINELS; ++i) {
-            uint16_t eaddr = sentinels[i];                // E000 or F000
-            uint16_t off   = (uint16_t)(eaddr - 0xE000);  // 0 or 0x1000
-
-            volatile uint8_t *e = (volatile uint8_t *)eaddr;
+            uint16_t off = (uint16_t)(sentinels[i] - 0xE000);
             volatile uint8_t *a = (volatile uint8_t *)(0xA000 + off);
             volatile uint8_t *c = (volatile uint8_t *)(0xC000 + off);
+            uint8_t t = tag_byte(s, i);
 
-            uint8_t t  = tag_byte((uint8_t)s, i);
-            uint8_t v0 = e[0];
-            uint8_t v1 = e[1];
-
-            // First, ensure our tag stuck in E-window
-            if (v0 != t || v1 != (uint8_t)~t) { shadow = TRUE; break; }
-
-            // Read originals from lower RAM so we can restore if mirrored
-            uint8_t oa0 = a[0], oa1 = a[1];
-            uint8_t oc0 = c[0], oc1 = c[1];
-
-            // If either lower block shows (tag, ~tag), this selection shadows base RAM
-            if ((oa0 == v0 && oa1 == v1) || (oc0 == v0 && oc1 == v1)) {
-                // restore whichever mirrored (mirroring made them equal to v0/v1)
-                if (oa0 == v0 && oa1 == v1) { a[0] = oa0; a[1] = oa1; }
-                if (oc0 == v0 && oc1 == v1) { c[0] = oc0; c[1] = oc1; }
+            if ((a[0] == t && a[1] == (uint8_t)~t) ||
+                (c[0] == t && c[1] == (uint8_t)~t)) {
                 shadow = TRUE;
                 break;
             }
@@ -134,78 +114,142 @@ uint16_t count_banks(void) {
 
         if (shadow) {
             #ifdef DEBUG
-            sprintf(termbuffer, " -> SHADOW of lower RAM; early exit");
-            terminal_printtermbuffer();
+            print_info(" -> SHADOW of lower RAM; early exit", 0);
             #endif
             break; // banks are sequential; first shadow means no more real banks
         }
 
-        // Alias detection against previously found banks
-        for (uint16_t j = 0; j < repcnt; ++j) {
-            uint8_t r = reps[j];
+        nrbanks++;
 
-            z80_outp(0x94, r);
-            if (!verify_signature(r)) {
-                alias = TRUE;
+        #ifdef DEBUG
+        terminal_beginline();
+        fmt_str(" -> NEW BANK, total so far: ");
+        fmt_dec(nrbanks, 0);
+        terminal_newline();
+        #endif
+    }
 
-                #ifdef DEBUG
-                sprintf(termbuffer, " -> ALIAS of selector %3u; early exit", (unsigned)r);
-                terminal_printtermbuffer();
-                #endif
+    return nrbanks;
+}
 
-                // restore r's signature so any later code sees it correct
-                z80_outp(0x94, r);
-                write_signature(r);
-                break;
-            }
-        }
+/**
+ * Count the number of banks in two sweeps. First, a signature is written to
+ * the sentinel addresses of every selector in descending order, such that a
+ * physical bank ends up holding the signature of the lowest selector mapping
+ * onto it. Next, the selectors are read back in ascending order; the first
+ * selector that does not return its own signature aliases a lower selector
+ * (or does not exist) and the first selector whose signature also appears in
+ * lower memory shadows base RAM. In both cases no further banks are present.
+ *
+ * The selectors beyond LOW_SELECTORS, which write port 0x95, are only swept
+ * when all LOW_SELECTORS selectors hold a bank, i.e. on the 2080 KiB board.
+ */
+uint16_t count_banks(void) {
+    static uint8_t backup[NR_SENTINELS][4];   // avoid stack use
 
-        if (alias) {
-            break; // early exit on first alias (sequential guarantee)
-        }
+    bank_select(0); // start from a known bank
 
-        // New, distinct bank
-        reps[repcnt++] = (uint8_t)s;
+    // store lower memory at the shadow positions and scrub it with a value
+    // that can never match a signature
+    for (uint8_t i = 0; i < NR_SENTINELS; ++i) {
+        uint16_t off = (uint16_t)(sentinels[i] - 0xE000);  // 0 or 0x1000
+        volatile uint8_t *a = (volatile uint8_t *)(0xA000 + off);
+        volatile uint8_t *c = (volatile uint8_t *)(0xC000 + off);
+
+        backup[i][0] = a[0]; backup[i][1] = a[1];
+        backup[i][2] = c[0]; backup[i][3] = c[1];
+        a[0] = 0x00; a[1] = 0x00;
+        c[0] = 0x00; c[1] = 0x00;
+    }
 
-        #ifdef DEBUG
-        sprintf(termbuffer, " -> NEW BANK, total so far: %u", (unsigned)repcnt);
-        terminal_printtermbuffer();
-        #endif
+    uint16_t nrbanks = count_selectors(LOW_SELECTORS);
+    if (nrbanks == LOW_SELECTORS) {
+        nrbanks = count_selectors(MAX_SELECTORS);
+    }
+
+    // restore lower memory
+    bank_select(0);
+    for (uint8_t i = 0; i < NR_SENTINELS; ++i) {
+        uint16_t off = (uint16_t)(sentinels[i] - 0xE000);
+        volatile uint8_t *a = (volatile uint8_t *)(0xA000 + off);
+        volatile uint8_t *c = (volatile uint8_t *)(0xC000 + off);
+
+        a[0] = backup[i][0]; a[1] = backup[i][1];
+        c[0] = backup[i][2]; c[1] = backup[i][3];
     }
 
     set_bank(0); // leave system in a known state
 
     #ifdef DEBUG
-    sprintf(termbuffer, "NR BANKS: %u", (unsigned)repcnt);
-    terminal_printtermbuffer();
+    terminal_beginline();
+    fmt_str("NR BANKS: ");
+    fmt_dec(nrbanks, 0);
+    terminal_newline();
     #endif
 
-    return repcnt;
+    return nrbanks;
+}
+
+/**
+ * Probe whether the selector switches the 16 KiB high memory window at
+ * 0xA000-0xDFFF to a different bank than selector 0.
+ */
+uint8_t probe_highmem_bank(bankaddr_t selector) {
+    volatile uint8_t *p = (volatile uint8_t *)HIGHMEM_START;
+
+    bank_select(0);
+    p[0] = 0x5A;
+    p[1] = 0xA5;
+
+    // write the complement via the probed selector
+    bank_select(selector);
+    p[0] = 0xA5;
+    p[1] = 0x5A;
+
+    // the original values survive only when another bank was written
+    bank_select(0);
+    uint8_t distinct = (p[0] == 0x5A && p[1] == 0xA5);
+
+    set_bank(0);
+    return distinct;
 }
 
 /**
- * @brief Set the bank in memory, informs the user in a status bar and writes
- *        the current position of the stack pointer to the screen
+ * @brief Set the bank in memory and count the selection towards the progress
+ *        of the current test; the status line is drawn from the interrupt
+ *        handler (see progress.h)
  * 
  * @param bank id
  */
-void set_bank(uint8_t bank) {
-    z80_outp(0x94, bank);
+void set_bank(bankaddr_t bank) {
+    bank_select(bank);
+    progress_done++;
+}
 
-    // placeholder for bit pattern (terminating char = 0)
-    uint8_t char_bits[9] = {' ',' ',' ',' ',' ',' ',' ',' ',0};
+/**
+ * @brief Informs the user of the current bank in a status bar and writes the
+ *        current position of the stack pointer to the screen
+ */
+void bank_status_render(void) {
+    bankaddr_t bank = current_bank;
 
-    // build bit pattern
-    for(uint8_t i=0; i<8; i++) {
-        if((bank & (1 << i)) != 0) {
-            char_bits[7-i] = GRAPH_BLOCK;
-        } else {
-            char_bits[7-i] = ' '; // write space
-        }
-    }
+    // the status line may be refreshed while a terminal line is composed
+    char* cursor = fmt_ptr;
 
     memset(vidmem, 0, 40);
     vidmem[0x00] = COL_MAGENTA;
-    sprintf(&vidmem[1], "Bank register: |%s| (%u)", char_bits, bank);
+    fmt_at(&vidmem[1]);
+    fmt_str("Bank register: |");
+
+    // build bit pattern
+    for(uint8_t i=8; i-- > 0; ) {
+        fmt_char((bank & (1 << i)) != 0 ? GRAPH_BLOCK : ' ');
+    }
+
+    fmt_str("| (");
+    fmt_dec(bank, 0);
+    fmt_char(')');
     write_stack_pointer();
-}
\ No newline at end of file
+
+    fmt_ptr = cursor;
+}
@@ -27,39 +27,81 @@
 #include "config.h"
 #include "terminal.h"
 #include "stack.h"
+#include "util.h"
+#include "progress.h"
 
 #define NR_SENTINELS    2
-#define MAX_SELECTORS 256
+#define MAX_SELECTORS 512
+#define LOW_SELECTORS 256   // selectors that leave port 0x95 at zero
+
+#define HIGHBANK_1056   0x0080  // bit 7 of port 0x94 selects upper 16 KiB bank
+#define HIGHBANK_2080   0x0100  // bit 0 of port 0x95 selects upper 16 KiB bank
+
+/*
+ * Bank address; the low byte is written to the bank register at port 0x94,
+ * the high byte to the high bank register at port 0x95.
+ */
+typedef uint16_t bankaddr_t;
+
+// bank address that was last written to the bank registers
+extern bankaddr_t current_bank;
+
+/**
+ * @brief Write the bank register without updating the status line; use
+ *        this function in time-critical loops
+ *
+ * @param bank id
+ */
+void bank_select(bankaddr_t bank) __z88dk_fastcall;
 
 /**
- * @brief Set the bank in memory, informs the user in a status bar and writes
- *        the current position of the stack pointer to the screen
+ * @brief Set the bank in memory and count the selection towards the progress
+ *        of the current test; the status line is drawn from the interrupt
+ *        handler (see progress.h)
  * 
  * @param bank id
  */
-void set_bank(uint8_t bank);
+void set_bank(bankaddr_t bank);
+
+/**
+ * @brief Informs the user of the current bank in a status bar and writes the
+ *        current position of the stack pointer to the screen
+ */
+void bank_status_render(void);
 
 /**
  * Construct unique identifier byte
  */
-uint8_t tag_byte(uint8_t selector, uint8_t idx);
+uint8_t tag_byte(bankaddr_t selector, uint8_t idx);
 
 /**
  * Write signature to sentinel addresses on bank identified by selector
  */
-void write_signature(uint8_t selector);
+void write_signature(bankaddr_t selector);
 
 /**
  * Checks for all sentinel addresses whether the value is correctly returned
  */
-uint8_t verify_signature(uint8_t selector);
+uint8_t verify_signature(bankaddr_t selector);
 
 /**
- * Count the number of banks by writing a tag value to sentinel addresses. Next,
- * all other banks are screened for aliasing. If an alias is encountered, this means
- * that we have 'wrapped around' in the bank bits and thus no new banks are found.
- * This function performs early exit.
+ * Count the number of banks in two sweeps. First, a signature is written to
+ * the sentinel addresses of every selector in descending order, such that a
+ * physical bank ends up holding the signature of the lowest selector mapping
+ * onto it. Next, the selectors are read back in ascending order; the first
+ * selector that does not return its own signature aliases a lower selector
+ * (or does not exist) and the first selector whose signature also appears in
+ * lower memory shadows base RAM. In both cases no further banks are present.
+ *
+ * The selectors beyond LOW_SELECTORS, which write port 0x95, are only swept
+ * when all LOW_SELECTORS selectors hold a bank, i.e. on the 2080 KiB board.
  */
 uint16_t count_banks(void);
 
+/**
+ * Probe whether the selector switches the 16 KiB high memory window at
+ * 0xA000-0xDFFF to a different bank than selector 0.
+ */
+uint8_t probe_highmem_bank(bankaddr_t selector);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,63 @@
+/**************************************************************************
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   P2000T-RAMTESTER is free software:                                   *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   P2000T-RAMTESTER software is distributed in the hope that it will    *
+ *   be useful, but WITHOUT ANY WARRANTY; without even the implied        *
+ *   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#include "bankgrid.h"
+
+static char* _bankgrid = 0;  // color code of the cell of bank 0
+
+void bankgrid_init(uint16_t nrbanks) {
+    uint8_t rows = (nrbanks + BANKGRID_COLS - 1) / BANKGRID_COLS;
+    if(rows == 0) {
+        return;
+    }
+
+    // keep a blank line between the terminal and the grid
+    uint8_t top = BANKGRID_LASTLINE + 1 - rows;
+    if(top - 2 < _terminal_endline) {
+        terminal_resize(top - 2);
+    }
+    memset(&vidmem[LINESTRIDE * (top - 1)], 0x00, LINELENGTH);
+
+    uint16_t bank = 0;
+    for(uint8_t r=0; r<rows; r++) {
+        char* line = &vidmem[LINESTRIDE * (top + r)];
+        memset(line, 0x00, LINELENGTH);
+        fmt_at(line);
+        fmt_hex8((uint8_t)bank);
+        fmt_char(' ');
+        for(uint8_t c=0; c<BANKGRID_COLS && bank < nrbanks; c++, bank++) {
+            fmt_char(BANKGRID_IDLE);
+            fmt_char(GRAPH_BLOCK);
+        }
+    }
+
+    _bankgrid = &vidmem[LINESTRIDE * top + BANKGRID_LABEL];
+}
+
+void bankgrid_set(uint8_t bank, uint8_t state) {
+    char* cell = &_bankgrid[(bank >> 4) * LINESTRIDE + (bank & 0x0F) * 2];
+    if(*cell != BANKGRID_FAIL) {
+        *cell = state;
+    }
+}
+
+uint8_t bankgrid_get(uint8_t bank) {
+    return _bankgrid[(bank >> 4) * LINESTRIDE + (bank & 0x0F) * 2];
+}
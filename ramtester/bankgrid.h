@@ -0,0 +1,71 @@
+/**************************************************************************
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   P2000T-RAMTESTER is free software:                                   *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   P2000T-RAMTESTER software is distributed in the hope that it will    *
+ *   be useful, but WITHOUT ANY WARRANTY; without even the implied        *
+ *   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#ifndef _BANKGRID_H
+#define _BANKGRID_H
+
+#include <stdint.h>
+
+#include "constants.h"
+#include "memory.h"
+#include "terminal.h"
+#include "format.h"
+
+/*
+ * The bank grid shows the state of every 8 KiB bank at a fixed position at
+ * the bottom of the screen, 16 banks per line. Every cell consists of a
+ * color code followed by a block character, such that updating a bank is a
+ * single write of its color code. The terminal is shrunk to the lines above
+ * the grid.
+ */
+
+#define BANKGRID_COLS       16
+#define BANKGRID_LASTLINE   23
+#define BANKGRID_LABEL      3       // width of the "00 " label per line
+
+#define BANKGRID_IDLE       COL_BLUE    // not visited yet
+#define BANKGRID_WRITTEN    COL_CYAN    // pattern written, not verified
+#define BANKGRID_PASS       COL_GREEN   // verified
+#define BANKGRID_FAIL       COL_RED     // failed; kept for the remainder of the run
+
+/**
+ * @brief Draw an empty grid for a number of banks and shrink the terminal
+ *
+ * @param nrbanks number of 8 KiB banks (at most 256)
+ */
+void bankgrid_init(uint16_t nrbanks);
+
+/**
+ * @brief Set the state of a bank; a failed bank remains marked as failed
+ *
+ * @param bank  bank number
+ * @param state one of the BANKGRID_* states
+ */
+void bankgrid_set(uint8_t bank, uint8_t state);
+
+/**
+ * @brief Get the state of a bank
+ *
+ * @param bank bank number
+ * @return uint8_t one of the BANKGRID_* states
+ */
+uint8_t bankgrid_get(uint8_t bank);
+
+#endif // _BANKGRID_H
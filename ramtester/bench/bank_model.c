@@ -0,0 +1,127 @@
+/**************************************************************************
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   P2000T-RAMTESTER is free software:                                   *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   P2000T-RAMTESTER software is distributed in the hope that it will    *
+ *   be useful, but WITHOUT ANY WARRANTY; without even the implied        *
+ *   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+/*
+ * Bank register model used by the benchmark harness in place of bank.asm.
+ *
+ * z88dk-ticks offers a flat 64 KiB address space without any I/O devices,
+ * hence ports 0x94 and 0x95 are emulated in software. Only the bytes used
+ * for bank detection (the sentinels at 0xE000/0xF000 and the probe and shadow
+ * positions in upper memory) are stored per bank; all other bytes of the
+ * bank window are shared between banks. This is sufficient to let
+ * count_banks() and probe_highmem_bank() identify the board, and to time
+ * any test that visits a single bank.
+ *
+ * Copying these bytes costs far more T-states than the OUT instructions of
+ * bank.asm, such that the test figures of the benchmark overstate the cost of
+ * every bank selection; see bench/run.sh.
+ *
+ * The board is selected at compile time via BENCH_BOARD (size in KiB).
+ */
+
+#include <stdint.h>
+
+#include "../memory.h"
+#include "../bankcounting.h"
+
+#if BENCH_BOARD == 64
+#define MODEL_EBANKS    6
+#define MODEL_EMASK     0x07
+#define MODEL_HIGHBIT   0x0000
+#elif BENCH_BOARD == 128
+#define MODEL_EBANKS    14
+#define MODEL_EMASK     0x0F
+#define MODEL_HIGHBIT   0x0000
+#elif BENCH_BOARD == 512
+#define MODEL_EBANKS    62
+#define MODEL_EMASK     0x3F
+#define MODEL_HIGHBIT   0x0000
+#elif BENCH_BOARD == 1056
+#define MODEL_EBANKS    128
+#define MODEL_EMASK     0x7F
+#define MODEL_HIGHBIT   HIGHBANK_1056
+#elif BENCH_BOARD == 2080
+#define MODEL_EBANKS    256
+#define MODEL_EMASK     0xFF
+#define MODEL_HIGHBIT   HIGHBANK_2080
+#else
+#error "Unsupported BENCH_BOARD"
+#endif
+
+#define NR_EBYTES   4
+#define NR_HBYTES   8
+
+bankaddr_t current_bank = 0;
+
+static uint16_t _ebank = 0;     // physical 8 KiB bank in the window
+static uint8_t _hbank = 0;      // physical 16 KiB bank in upper memory
+
+static uint8_t _ebytes[MODEL_EBANKS][NR_EBYTES];
+static uint8_t _hbytes[2][NR_HBYTES];
+
+static const uint16_t _eaddr[NR_EBYTES] = {
+    0xE000, 0xE001, 0xF000, 0xF001
+};
+
+static const uint16_t _haddr[NR_HBYTES] = {
+    0xA000, 0xA001, 0xB000, 0xB001, 0xC000, 0xC001, 0xD000, 0xD001
+};
+
+/**
+ * Location where byte i of the bank window of physical bank phys is stored;
+ * the two selectors beyond the last bank shadow upper memory at 0xA000 and
+ * 0xC000 respectively, as on the 64-512 KiB boards.
+ */
+static uint8_t* ebank_store(uint16_t phys, uint8_t i) {
+    if(phys >= MODEL_EBANKS) {
+        return &memory[_eaddr[i] - 0x4000 + (phys - MODEL_EBANKS) * 0x2000];
+    }
+    return &_ebytes[phys][i];
+}
+
+/**
+ * @brief Emulate a write to the bank registers
+ *
+ * @param bank id
+ */
+void bank_select(bankaddr_t bank) __z88dk_fastcall {
+    uint8_t hbank = (bank & MODEL_HIGHBIT) ? 1 : 0;
+    uint16_t ebank = bank & MODEL_EMASK;
+
+    // store the window of the current banks and load the new ones
+    for(uint8_t i=0; i<NR_EBYTES; i++) {
+        *ebank_store(_ebank, i) = memory[_eaddr[i]];
+    }
+
+    if(hbank != _hbank) {
+        for(uint8_t i=0; i<NR_HBYTES; i++) {
+            _hbytes[_hbank][i] = memory[_haddr[i]];
+            memory[_haddr[i]] = _hbytes[hbank][i];
+        }
+        _hbank = hbank;
+    }
+
+    for(uint8_t i=0; i<NR_EBYTES; i++) {
+        memory[_eaddr[i]] = *ebank_store(ebank, i);
+    }
+    _ebank = ebank;
+
+    current_bank = bank;
+}
@@ -0,0 +1,189 @@
+/**************************************************************************
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   P2000T-RAMTESTER is free software:                                   *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   P2000T-RAMTESTER software is distributed in the hope that it will    *
+ *   be useful, but WITHOUT ANY WARRANTY; without even the implied        *
+ *   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+/*
+ * Benchmark harness for z88dk-ticks. Every build of this file measures a
+ * single case, selected via BENCH_<CASE>, by placing the TIMER_START and
+ * TIMER_STOP labels around it; bench/run.sh passes the addresses of these
+ * labels to z88dk-ticks, which reports the exact number of T-states spent
+ * in between.
+ *
+ * Kernel cases operate on a single 8 KiB bank. Test cases run the tests of
+ * main.c on BENCH_H high memory banks and BENCH_N 8 KiB banks; run.sh
+ * combines three such measurements into the runtime of a full board.
+ *
+ * Bank switching goes through the software model of bench/bank_model.c, which
+ * is far slower than bank.asm; the test cases therefore only serve to compare
+ * builds of this harness and do not give the runtime on a real P2000T (see
+ * run.sh).
+ */
+
+#include <stdint.h>
+#include <intrinsic.h>
+
+#include "../config.h"
+#include "../memory.h"
+#include "../ramtest.h"
+#include "../fill.h"
+#include "../bankcounting.h"
+#include "../bankgrid.h"
+
+#ifndef BENCH_H
+#define BENCH_H 0
+#endif
+
+#ifndef BENCH_N
+#define BENCH_N 0
+#endif
+
+#define TIMER_START()   intrinsic_label(TIMER_START)
+#define TIMER_STOP()    intrinsic_label(TIMER_STOP)
+
+// from main.c
+extern uint8_t highmembanks;
+extern uint16_t uppermembanks;
+extern bankaddr_t highbank_selector;
+void init(void);
+void ram_test_04(void);
+void ram_test_05(void);
+void ram_test_06(void);
+void ram_test_07(void);
+void ram_test_pipeline(void);
+void ram_test_08(void);
+void ram_test_09(void);
+void ram_test_10(void);
+void ram_test_11(void);
+void ram_test_12(void);
+void ram_test_13(void);
+void ram_test_14(void);
+
+int main(void) {
+    char *bank = &memory[BANKMEM_START];
+
+    init();
+    highmembanks = BENCH_H;
+    uppermembanks = BENCH_N;
+    highbank_selector = (BENCH_BOARD == 1056) ? HIGHBANK_1056 : HIGHBANK_2080;
+    bankgrid_init(uppermembanks);
+
+#if defined(BENCH_COUNT_RAM_BYTES)
+    TIMER_START();
+    count_ram_bytes(bank, 0x00, BANK_BYTES);
+    TIMER_STOP();
+#elif defined(BENCH_FILL_RAM_BYTES)
+    TIMER_START();
+    fill_ram_bytes(bank, 0x00, BANK_BYTES);
+    TIMER_STOP();
+#elif defined(BENCH_FILL_VERIFY_RAM_BYTES)
+    TIMER_START();
+    fill_verify_ram_bytes(bank, 0x00, 0x00, BANK_BYTES);
+    TIMER_STOP();
+#elif defined(BENCH_FILL_VERIFY_RAM_BYTES_DESC)
+    TIMER_START();
+    fill_verify_ram_bytes_desc(bank, 0x00, 0x00, BANK_BYTES);
+    TIMER_STOP();
+#elif defined(BENCH_FILL_BANK_WINDOW)
+    TIMER_START();
+    fill_bank_window(PATTERN16(0x00));
+    TIMER_STOP();
+#elif defined(BENCH_FILL_ADDR_PATTERN)
+    TIMER_START();
+    fill_addr_pattern(bank, 0x00, BANK_PAGES);
+    TIMER_STOP();
+#elif defined(BENCH_COUNT_ADDR_PATTERN)
+    fill_addr_pattern(bank, 0x00, BANK_PAGES);
+    TIMER_START();
+    count_addr_pattern(bank, 0x00, BANK_PAGES);
+    TIMER_STOP();
+#elif defined(BENCH_FILL_LFSR_PATTERN)
+    TIMER_START();
+    fill_lfsr_pattern(bank, 0x0000, BANK_PAGES);
+    TIMER_STOP();
+#elif defined(BENCH_COUNT_LFSR_PATTERN)
+    fill_lfsr_pattern(bank, 0x0000, BANK_PAGES);
+    TIMER_START();
+    count_lfsr_pattern(bank, 0x0000, BANK_PAGES);
+    TIMER_STOP();
+#elif defined(BENCH_CRC16_RAM_PAGES)
+    TIMER_START();
+    crc16_ram_pages(bank, CRC16_INIT, BANK_PAGES);
+    TIMER_STOP();
+#elif defined(BENCH_BANK_SELECT)
+    TIMER_START();
+    bank_select(1);
+    TIMER_STOP();
+#elif defined(BENCH_TEST_02)
+    TIMER_START();
+    count_banks();
+    TIMER_STOP();
+#elif defined(BENCH_TEST_04)
+    TIMER_START();
+    ram_test_04();
+    TIMER_STOP();
+#elif defined(BENCH_TEST_05)
+    TIMER_START();
+    ram_test_05();
+    TIMER_STOP();
+#elif defined(BENCH_TEST_06)
+    TIMER_START();
+    ram_test_06();
+    TIMER_STOP();
+#elif defined(BENCH_TEST_07)
+    TIMER_START();
+    ram_test_07();
+    TIMER_STOP();
+#elif defined(BENCH_TEST_08)
+    TIMER_START();
+    ram_test_08();
+    TIMER_STOP();
+#elif defined(BENCH_TEST_09)
+    TIMER_START();
+    ram_test_09();
+    TIMER_STOP();
+#elif defined(BENCH_TEST_10)
+    TIMER_START();
+    ram_test_10();
+    TIMER_STOP();
+#elif defined(BENCH_TEST_11)
+    TIMER_START();
+    ram_test_11();
+    TIMER_STOP();
+#elif defined(BENCH_TEST_12)
+    TIMER_START();
+    ram_test_12();
+    TIMER_STOP();
+#elif defined(BENCH_TEST_13)
+    TIMER_START();
+    ram_test_13();
+    TIMER_STOP();
+#elif defined(BENCH_TEST_14)
+    TIMER_START();
+    ram_test_14();
+    TIMER_STOP();
+#elif defined(BENCH_TEST_16)
+    TIMER_START();
+    ram_test_pipeline();
+    TIMER_STOP();
+#else
+#error "No benchmark case selected"
+#endif
+
+    return 0;
+}
@@ -0,0 +1,88 @@
+#!/bin/sh
+
+#
+# Measures the T-states spent in the RAM tester kernels and tests using
+# z88dk-ticks. Invoked from the Makefile as
+#
+#   sh bench/run.sh <source files>
+#
+# Results are written to bench/build/results.txt as "<case> <T-states>" lines.
+#
+# The bank model of the harness stores only a few bytes per bank, such that
+# the tests cannot run over all banks of a board at once. Every test is
+# therefore measured with (high banks, banks) = (0,0), (1,0) and (0,1), from
+# which the runtime of a complete board is obtained as
+#
+#   T = T(0,0) + H * (T(1,0) - T(0,0)) + N * (T(0,1) - T(0,0))
+#
+# The single-bank measurement includes the per-bank update of the bank grid,
+# which is performed once per bank on a full board as well.
+#
+# The test figures are NOT representative of the runtime on a real P2000T:
+# every bank selection runs the C bank model of bench/bank_model.c, which
+# copies the per-bank bytes in and out of the window, instead of the two OUT
+# instructions of bank.asm. The cost of a single selection in the model is
+# reported as kernel.BANK_SELECT. The test figures are meant for comparing
+# against bench/baseline.txt only; the kernel figures are exact.
+#
+
+set -e
+
+BUILD=bench/build
+RESULTS=$BUILD/results.txt
+CFLAGS="+test -compiler=sdcc -SO3 --max-allocs-per-node2000 -pragma-define:REGISTER_SP=0x9FFF -DBENCH"
+
+KERNELS="BANK_SELECT COUNT_RAM_BYTES FILL_RAM_BYTES FILL_VERIFY_RAM_BYTES FILL_VERIFY_RAM_BYTES_DESC FILL_BANK_WINDOW FILL_ADDR_PATTERN COUNT_ADDR_PATTERN FILL_LFSR_PATTERN COUNT_LFSR_PATTERN CRC16_RAM_PAGES"
+TESTS="04 05 06 07 08 09 10 11 12 13 14 16"
+BOARDS="64 128 512 1056 2080"
+
+mkdir -p $BUILD
+: > $RESULTS
+
+# measure(case, board, H, N, sources...): build the harness and print the
+# number of T-states between TIMER_START and TIMER_STOP
+measure() {
+    name=$BUILD/$1_$2_$3_$4
+    flags="-DBENCH_$1 -DBENCH_BOARD=$2 -DBENCH_H=$3 -DBENCH_N=$4"
+    shift 4
+    zcc $CFLAGS $flags "$@" bench/bank_model.c bench/bench.c -o $name.bin -m > /dev/null
+    start=$(awk '$1 == "TIMER_START" { sub(/\$/, "", $3); print $3 }' $name.map)
+    stop=$(awk '$1 == "TIMER_STOP" { sub(/\$/, "", $3); print $3 }' $name.map)
+    z88dk-ticks -start $start -end $stop -counter 4000000000 $name.bin | \
+        grep -o '[0-9]\+' | tail -n 1
+}
+
+# board(size): print number of high memory banks and 8 KiB banks
+board() {
+    case $1 in
+        64)   echo "1 6" ;;
+        128)  echo "1 14" ;;
+        512)  echo "1 62" ;;
+        1056) echo "2 128" ;;
+        2080) echo "2 256" ;;
+    esac
+}
+
+SRC="$*"
+set --
+
+for k in $KERNELS; do
+    t=$(measure $k 2080 0 0 $SRC)
+    echo "kernel.$k $t" | tee -a $RESULTS
+done
+
+for b in $BOARDS; do
+    t=$(measure TEST_02 $b 0 0 $SRC)
+    echo "test02.$b $t" | tee -a $RESULTS
+done
+
+for n in $TESTS; do
+    t00=$(measure TEST_$n 2080 0 0 $SRC)
+    t10=$(measure TEST_$n 2080 1 0 $SRC)
+    t01=$(measure TEST_$n 2080 0 1 $SRC)
+    for b in $BOARDS; do
+        set -- $(board $b)
+        t=$((t00 + $1 * (t10 - t00) + $2 * (t01 - t00)))
+        echo "test$n.$b $t" | tee -a $RESULTS
+    done
+done
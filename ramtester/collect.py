@@ -0,0 +1,236 @@
+#
+# Collect test results from the serial output of one or more P2000Ts
+#
+# Requirements: pyserial module (only for --port)
+#
+# Usage: python collect.py [--port PORT]... [--pty N] [--logdir DIR] [--once]
+#
+# The RAM tester streams its results as checksummed records at 9600 baud,
+# 8N1, see serial.h for the record types. Every port is read from its own
+# thread and every machine is named after its port. Valid records are
+# appended to DIR/<machine>.log together with their time of arrival, and
+# every completed run adds a line to DIR/summary.csv. Burn-in passes, which
+# follow a run, are reported but not summarized.
+#
+# With --pty, N pseudo-terminals are opened and their device paths printed,
+# which are passed to the emulator via p2ksim -S, such that the collector can
+# be tested without hardware.
+#
+
+import argparse
+import csv
+import os
+import threading
+import time
+import tty
+
+BAUD_RATE = 9600
+TICK_SECONDS = 0.02         # the monitor counts ticks at 50 Hz
+NR_TESTS = 16
+SUMMARY_FILE = 'summary.csv'
+SUMMARY_FIELDS = ['time', 'machine', 'version', 'banks', 'high_banks', 'profile', 'seed', 'failed_checks',
+                  'faults', 'failed_banks', 'seconds'] + \
+                 ['test%i' % (i + 1) for i in range(NR_TESTS)]
+
+# serializes access to the summary file and to stdout from the reader threads
+summary_lock = threading.Lock()
+
+def main():
+    parser = argparse.ArgumentParser(description='Collect RAM tester results over serial lines')
+    parser.add_argument('--port', action='append', default=[],
+                        help='serial port connected to a P2000T, can be repeated')
+    parser.add_argument('--pty', type=int, default=0,
+                        help='number of pseudo-terminals to open for the emulator')
+    parser.add_argument('--logdir', default='results',
+                        help='directory for the logs and the summary (default: results)')
+    parser.add_argument('--once', action='store_true',
+                        help='stop after a single run has been received per port')
+    args = parser.parse_args()
+
+    sources = [SerialSource(p) for p in args.port]
+    sources += [PtySource() for i in range(args.pty)]
+    if not sources:
+        parser.error('no --port or --pty given')
+
+    for src in sources:
+        if isinstance(src, PtySource):
+            print(src.device, flush=True)
+
+    os.makedirs(args.logdir, exist_ok=True)
+    threads = [threading.Thread(target=collect, args=(src, args.logdir, args.once), daemon=True)
+               for src in sources]
+    for t in threads:
+        t.start()
+    try:
+        for t in threads:
+            t.join()
+    except KeyboardInterrupt:
+        pass
+
+class SerialSource:
+    def __init__(self, port):
+        import serial   # not needed for --pty, which runs without pyserial
+        self.ser = serial.Serial(port, BAUD_RATE, bytesize=serial.EIGHTBITS,
+                                 parity=serial.PARITY_NONE, stopbits=serial.STOPBITS_ONE,
+                                 timeout=None)
+        self.name = machine_name(port)
+
+    def readline(self):
+        return self.ser.readline()
+
+class PtySource:
+    def __init__(self):
+        master, slave = os.openpty()
+        tty.setraw(slave)
+        self.device = os.ttyname(slave)
+        self.name = machine_name(self.device)
+        self.slave = slave      # keep open such that the device persists
+        self.file = os.fdopen(master, 'rb', buffering=0)
+
+    def readline(self):
+        return self.file.readline()
+
+def machine_name(port):
+    """
+    Name a machine after its port, e.g. /dev/ttyUSB0 -> ttyUSB0, /dev/pts/3 -> pts_3
+    """
+    if port.startswith('/dev/'):
+        port = port[5:]
+    return port.replace('/', '_').replace('\\', '_')
+
+def checksum(payload):
+    """
+    XOR of all characters between '$' and '*'
+    """
+    value = 0
+    for c in payload:
+        value ^= c
+    return value
+
+def parse_record(line):
+    """
+    Return the fields of a record, starting with the record type, or None
+    when the line is not a valid record
+    """
+    line = line.strip()
+    if len(line) < 5 or line[:1] != b'$' or line[-3:-2] != b'*':
+        return None
+    payload = line[1:-3]
+    try:
+        if int(line[-2:], 16) != checksum(payload):
+            return None
+    except ValueError:
+        return None
+    return payload.decode('ascii', 'replace').split(',')
+
+def new_run():
+    return {'version': '', 'banks': '', 'high_banks': '', 'profile': '', 'seed': '', 'tests': {}, 'checks': {},
+            'grid': {}, 'faults': 0}
+
+def collect(src, logdir, once):
+    """
+    Read records from a single source until the end of a run (with once) or
+    until the source closes
+    """
+    run = new_run()
+    rejected = 0
+    with open(os.path.join(logdir, src.name + '.log'), 'a') as log:
+        while True:
+            line = src.readline()
+            if not line:
+                break
+            rec = parse_record(line)
+            if rec is None:
+                if line.strip():
+                    rejected += 1
+                    report(src.name, 'rejected corrupt line (%i so far)' % rejected)
+                continue
+
+            log.write('%s %s\n' % (time.strftime('%Y-%m-%d %H:%M:%S'), ','.join(rec)))
+            log.flush()
+
+            kind, fields = rec[0], rec[1:]
+            try:
+                if kind == 'H':
+                    run = new_run()
+                    run['version'] = fields[1]
+                    report(src.name, 'run started, version %s' % run['version'])
+                elif kind == 'B':
+                    run['banks'], run['high_banks'] = fields[0], fields[1]
+                    report(src.name, '%s banks, %s high memory banks' % (fields[0], fields[1]))
+                elif kind == 'P':
+                    run['profile'] = fields[0]
+                    report(src.name, 'profile %s' % fields[0])
+                elif kind == 'L':
+                    run['seed'] = fields[0]
+                    report(src.name, 'random data seed 0x%s' % fields[0])
+                elif kind == 'T':
+                    secs = int(fields[1]) * TICK_SECONDS
+                    run['tests'][int(fields[0])] = secs
+                    report(src.name, 'test %s done in %.2f s' % (fields[0], secs))
+                elif kind == 'R':
+                    run['checks'][int(fields[0])] = int(fields[1])
+                elif kind == 'G':
+                    run['grid'][int(fields[0], 16)] = fields[1]
+                elif kind == 'S':
+                    run['faults'] = int(fields[0])
+                elif kind == 'I':
+                    errors = int(fields[2])
+                    report(src.name, 'burn-in pass %s done in %.2f s, %s' %
+                           (fields[0], int(fields[1]) * TICK_SECONDS,
+                            'OK' if errors == 0 else '%i error(s)' % errors))
+                elif kind == 'K':
+                    row = int(fields[0], 16)
+                    name = 'high memory bank %i' % (row - 0x100) if row >= 0x100 else 'bank %i' % row
+                    report(src.name, '%s: %s error(s), first in pass %s, %s failing pass(es)' %
+                           (name, fields[1], fields[2], fields[3]))
+                elif kind == 'E':
+                    summary = summarize(src.name, run)
+                    report(src.name, '%s, %s failed check(s), %i fault(s)' %
+                           ('PASSED' if summary['failed_checks'] == 0 else 'FAILED',
+                            summary['failed_checks'], run['faults']))
+                    store_summary(logdir, summary)
+                    run = new_run()
+                    if once:
+                        break
+            except (IndexError, ValueError):
+                report(src.name, 'malformed record: %s' % ','.join(rec))
+
+def summarize(machine, run):
+    failed_banks = ['%02X' % (first + i)
+                    for first, states in sorted(run['grid'].items())
+                    for i, s in enumerate(states) if s == 'F']
+    summary = {
+        'time': time.strftime('%Y-%m-%d %H:%M:%S'),
+        'machine': machine,
+        'version': run['version'],
+        'banks': run['banks'],
+        'high_banks': run['high_banks'],
+        'profile': run['profile'],
+        'seed': run['seed'],
+        'failed_checks': sum(1 for e in run['checks'].values() if e != 0),
+        'faults': run['faults'],
+        'failed_banks': ' '.join(failed_banks),
+        'seconds': '%.2f' % sum(run['tests'].values()),
+    }
+    for i in range(NR_TESTS):
+        secs = run['tests'].get(i + 1)
+        summary['test%i' % (i + 1)] = '' if secs is None else '%.2f' % secs
+    return summary
+
+def store_summary(logdir, summary):
+    path = os.path.join(logdir, SUMMARY_FILE)
+    with summary_lock:
+        header = not os.path.exists(path)
+        with open(path, 'a', newline='') as f:
+            writer = csv.DictWriter(f, fieldnames=SUMMARY_FIELDS)
+            if header:
+                writer.writeheader()
+            writer.writerow(summary)
+
+def report(machine, msg):
+    with summary_lock:
+        print('%s: %s' % (machine, msg), flush=True)
+
+if __name__ == '__main__':
+    main()
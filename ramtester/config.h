@@ -26,4 +26,8 @@
 #define TRUE  1
 #define FALSE 0
 
+// seed of test 11; by default the seed is taken from the tick counter and
+// printed, define it to replay a run with the printed seed
+//#define LFSR_SEED 0x1234
+
 #endif
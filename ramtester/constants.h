@@ -38,4 +38,11 @@
 
 #define INPUTLENGTH 40
 
+// key codes stored by the monitor at 0x6000: row * 8 + column of the
+// keyboard matrix
+#define KEY_1       46
+#define KEY_2       63
+#define KEY_3       4
+#define KEY_4       7
+
 #endif // _CONSTANTS_H
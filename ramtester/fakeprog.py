@@ -0,0 +1,115 @@
+#
+# Fake cartridge programmer to exercise upload.py without hardware
+#
+# Requirements: none (POSIX only)
+#
+# Usage: python fakeprog.py [--delay SECONDS] [--count N] [--no-rdbk]
+#
+# Opens a pseudo-terminal that behaves like the programmer and prints its
+# device path, which is passed to upload.py via --port. With --count, N
+# independent programmers are served from their own thread and every device
+# path is printed on a separate line. The flash chip is
+# emulated as a 512 KiB SST39SF040: erasing sets a 4 KiB sector to 0xFF and
+# programming can only clear bits. Besides the commands used by upload.py
+# (READINFO, DEVIDSST, ESST, WRBK) the read-back command RDBK is emulated,
+# which returns the 8-byte acknowledgement followed by 256 bytes. With
+# --no-rdbk, RDBK is ignored like on firmware that does not implement it.
+#
+
+import argparse
+import os
+import threading
+import time
+import tty
+
+FLASH_SIZE = 512 * 1024
+PAGE_SIZE = 256
+SECTOR_SIZE = 4 * 1024
+
+class FakeProgrammer:
+    def __init__(self, delay=0.0, rdbk=True):
+        self.flash = bytearray(b'\xff' * FLASH_SIZE)
+        self.delay = delay
+        self.rdbk = rdbk
+        self.stats = {}
+        self.master, slave = os.openpty()
+        tty.setraw(slave)
+        self.device = os.ttyname(slave)
+        self.slave = slave      # keep open such that the device persists
+
+    def read(self, n):
+        buf = b''
+        while len(buf) < n:
+            chunk = os.read(self.master, n - len(buf))
+            if not chunk:
+                raise EOFError()
+            buf += chunk
+        return buf
+
+    def write(self, data):
+        os.write(self.master, data)
+
+    def handle(self, cmd):
+        """
+        Process a single 8-byte command
+        """
+        name = cmd[:4].decode('ascii', 'replace')
+        self.stats[name] = self.stats.get(name, 0) + 1
+        if name == 'RDBK' and not self.rdbk:
+            return
+        time.sleep(self.delay)
+        self.write(cmd)     # acknowledge by echoing the command
+
+        if cmd == b'READINFO':
+            self.write(b'Ph2k-32u4-v1.0.3')
+        elif cmd == b'DEVIDSST':
+            self.write(bytes([0xBF, 0xB7]))
+        elif name == 'ESST':
+            addr = int(cmd[4:], 16) * PAGE_SIZE
+            addr -= addr % SECTOR_SIZE
+            self.flash[addr:addr+SECTOR_SIZE] = b'\xff' * SECTOR_SIZE
+            self.write(b'OK')
+        elif name == 'WRBK':
+            addr = int(cmd[4:], 16) * PAGE_SIZE
+            parcel = self.read(PAGE_SIZE)
+            for i, v in enumerate(parcel):
+                self.flash[addr + i] &= v
+            self.write(bytes([sum(parcel) & 0xFF]))
+        elif name == 'RDBK':
+            addr = int(cmd[4:], 16) * PAGE_SIZE
+            self.write(bytes(self.flash[addr:addr+PAGE_SIZE]))
+
+    def serve(self):
+        try:
+            while True:
+                self.handle(self.read(8))
+        except (EOFError, OSError):
+            pass
+
+def main():
+    parser = argparse.ArgumentParser(description='Fake cartridge programmer on a pseudo-terminal')
+    parser.add_argument('--delay', type=float, default=0.0,
+                        help='processing time per command in seconds')
+    parser.add_argument('--count', type=int, default=1,
+                        help='number of programmers (default: 1)')
+    parser.add_argument('--no-rdbk', action='store_true',
+                        help='ignore the read-back command RDBK')
+    args = parser.parse_args()
+
+    progs = [FakeProgrammer(args.delay, not args.no_rdbk) for i in range(args.count)]
+    for prog in progs:
+        print(prog.device, flush=True)
+
+    threads = [threading.Thread(target=prog.serve, daemon=True) for prog in progs]
+    for t in threads:
+        t.start()
+    try:
+        for t in threads:
+            t.join()
+    except KeyboardInterrupt:
+        pass
+    for prog in progs:
+        print(prog.device, prog.stats)
+
+if __name__ == '__main__':
+    main()
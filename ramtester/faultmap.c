@@ -0,0 +1,183 @@
+/**************************************************************************
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   P2000T-RAMTESTER is free software:                                   *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   P2000T-RAMTESTER software is distributed in the hope that it will    *
+ *   be useful, but WITHOUT ANY WARRANTY; without even the implied        *
+ *   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#include "faultmap.h"
+
+fault_t fault_log[FAULT_LOG_SIZE];
+uint8_t fault_head = 0;
+uint8_t fault_budget = 0;
+uint8_t fault_bank = 0;
+uint16_t fault_total = 0;
+uint16_t fault_bytes = 0;
+
+static uint16_t _fault_nrbanks = 0;
+static uint16_t _fault_bits[8];
+static uint16_t _fault_chips[FAULT_NR_CHIPS];
+
+void fault_init(uint16_t nrbanks) {
+    _fault_nrbanks = nrbanks;
+}
+
+/**
+ * Determine the chip holding a failing byte, where chip 0 is the base memory
+ * of the P2000T
+ */
+static uint8_t fault_chip(const fault_t *f) {
+    if(f->addr < HIGHMEM_START) {
+        return 0;
+    }
+
+    // 1056 and 2080 KiB boards: a 32 KiB chip for upper memory and 512 KiB
+    // chips (64 banks) for the bankable memory
+    if(_fault_nrbanks >= 128) {
+        return (f->addr < BANKMEM_START) ? 1 : 2 + (f->bank >> 6);
+    }
+
+    // other boards use +2 decoding: 0xA000 holds physical bank 1, 0xC000
+    // bank 0 and 0xE000 bank + 2, on 32 KiB chips (64 KiB board) or on
+    // 128 KiB chips
+    uint8_t phys;
+    if(f->addr >= BANKMEM_START) {
+        phys = f->bank + 2;
+    } else {
+        phys = (f->addr < 0xC000) ? 1 : 0;
+    }
+    return 1 + ((_fault_nrbanks <= 6) ? (phys >> 2) : (phys >> 4));
+}
+
+uint16_t fault_count_ram_bytes(char *memory, uint8_t val, uint16_t nrbytes, uint8_t bank) {
+    uint8_t head = fault_head;
+    fault_bank = bank;
+    fault_budget = FAULT_PER_REGION;
+    uint16_t miscounts = count_ram_bytes_capture(memory, val, nrbytes);
+    if(miscounts == 0) {
+        return 0;
+    }
+
+    // a region never straddles two chips, hence all its failing bytes are
+    // accounted to the chip of its first byte
+    fault_t region = {(uint16_t)memory, bank, 0};
+    uint8_t chip = fault_chip(&region);
+    if(chip < FAULT_NR_CHIPS) {
+        _fault_chips[chip] = sat_add(_fault_chips[chip], miscounts);
+    }
+    fault_bytes = sat_add(fault_bytes, miscounts);
+
+    // the failing bits are only known for the new records, at most
+    // FAULT_PER_REGION per call
+    while(head != fault_head) {
+        const fault_t *f = &fault_log[head];
+        for(uint8_t i=0; i<8; i++) {
+            if(f->mask & (1 << i)) {
+                _fault_bits[i]++;
+            }
+        }
+        head = (head + 1) & (FAULT_LOG_SIZE - 1);
+    }
+
+    return miscounts;
+}
+
+void fault_report(void) {
+    terminal_beginline();
+    fmt_str("  ");
+    fmt_dec(fault_bytes, 0);
+    fmt_str(" failing bytes, ");
+    fmt_dec(fault_total, 0);
+    fmt_str(" recorded");
+    terminal_newline();
+
+    // failing bits of the recorded bytes, D7-D4 and D3-D0
+    print_info("  Bits of the recorded bytes:", 0);
+    for(uint8_t j=0; j<2; j++) {
+        terminal_beginline();
+        fmt_char(' ');
+        for(uint8_t i=0; i<4; i++) {
+            uint8_t bit = 7 - j * 4 - i;
+            fmt_str(" D");
+            fmt_char('0' + bit);
+            fmt_dec(_fault_bits[bit], 6);
+        }
+        terminal_newline();
+    }
+
+    // faults per chip
+    for(uint8_t i=0; i<FAULT_NR_CHIPS; i++) {
+        if(_fault_chips[i] == 0) {
+            continue;
+        }
+        terminal_beginline();
+        if(i == 0) {
+            fmt_str("  * BASE RAM:");
+        } else {
+            fmt_str("  * CHIP ");
+            fmt_dec(i, 0);
+            fmt_str(":  ");
+        }
+        fmt_char(COL_RED);
+        fmt_dec(_fault_chips[i], 5);
+        terminal_newline();
+    }
+
+    // most recent records
+    uint8_t n = fault_total < FAULT_REPORT_LAST ? (uint8_t)fault_total : FAULT_REPORT_LAST;
+    uint8_t idx = (fault_head - n) & (FAULT_LOG_SIZE - 1);
+    for(uint8_t i=0; i<n; i++) {
+        const fault_t *f = &fault_log[idx];
+        terminal_beginline();
+        fmt_str("  ");
+        fmt_hex16(f->addr);
+        if(f->addr >= HIGHMEM_START) {
+            fmt_str(" BANK ");
+            fmt_hex8(f->bank);
+        }
+        fmt_str(" MASK ");
+        fmt_hex8(f->mask);
+        terminal_newline();
+        idx = (idx + 1) & (FAULT_LOG_SIZE - 1);
+    }
+}
+
+void fault_export(void) {
+    serial_begin('S');
+    serial_field_dec(fault_bytes);
+    for(uint8_t i=0; i<8; i++) {
+        serial_field_dec(_fault_bits[7 - i]);
+    }
+    serial_end();
+
+    serial_begin('C');
+    for(uint8_t i=0; i<FAULT_NR_CHIPS; i++) {
+        serial_field_dec(_fault_chips[i]);
+    }
+    serial_end();
+
+    uint8_t n = fault_total < FAULT_LOG_SIZE ? (uint8_t)fault_total : FAULT_LOG_SIZE;
+    uint8_t idx = (fault_head - n) & (FAULT_LOG_SIZE - 1);
+    for(uint8_t i=0; i<n; i++) {
+        const fault_t *f = &fault_log[idx];
+        serial_begin('F');
+        serial_field_hex16(f->addr);
+        serial_field_hex8(f->bank);
+        serial_field_hex8(f->mask);
+        serial_end();
+        idx = (idx + 1) & (FAULT_LOG_SIZE - 1);
+    }
+}
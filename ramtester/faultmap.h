@@ -0,0 +1,95 @@
+/**************************************************************************
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   P2000T-RAMTESTER is free software:                                   *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   P2000T-RAMTESTER software is distributed in the hope that it will    *
+ *   be useful, but WITHOUT ANY WARRANTY; without even the implied        *
+ *   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#ifndef _FAULTMAP_H
+#define _FAULTMAP_H
+
+#include <stdint.h>
+
+#include "constants.h"
+#include "memory.h"
+#include "terminal.h"
+#include "format.h"
+#include "ramtest.h"
+#include "serial.h"
+#include "util.h"
+
+/*
+ * Failing bytes found by the verify sweeps are recorded in a ring buffer by
+ * count_ram_bytes_capture. At most FAULT_PER_REGION bytes are recorded per
+ * region and sweep, such that a single bad chip cannot flush the records of
+ * other regions. All failing bytes are counted per memory chip, which allows
+ * pinpointing a bad chip from the summary. The failing data bits are only
+ * known for the recorded bytes, hence the counts per data bit are a sample.
+ *
+ * The ring buffer resides in the data segment at 0x6100, below the lower
+ * memory region that is overwritten by test 4.
+ */
+
+#define FAULT_LOG_SIZE      128     // records in ring buffer (power of two, see ramtest.asm)
+#define FAULT_PER_REGION    4       // records per region and sweep
+#define FAULT_NR_CHIPS      6       // base memory and up to 5 expansion chips
+#define FAULT_REPORT_LAST   4       // number of records listed in the summary
+
+typedef struct {
+    uint16_t addr;                  // address of the failing byte
+    uint8_t bank;                   // bank or high memory bank of the region
+    uint8_t mask;                   // bits that differ from the expected value
+} fault_t;
+
+extern fault_t fault_log[FAULT_LOG_SIZE];
+extern uint8_t fault_head;          // next record to write
+extern uint8_t fault_budget;        // records left for the current region
+extern uint8_t fault_bank;          // bank stored in new records
+extern uint16_t fault_total;        // number of records written
+extern uint16_t fault_bytes;        // number of failing bytes, saturates at 0xFFFF
+
+/**
+ * @brief Set the number of 8 KiB banks, used to map records onto chips
+ *
+ * @param nrbanks number of 8 KiB banks
+ */
+void fault_init(uint16_t nrbanks);
+
+/**
+ * @brief Count the bytes in a memory region that differ from a check byte,
+ *        recording the first FAULT_PER_REGION of them
+ *
+ * @param memory  pointer to start of region
+ * @param val     check byte
+ * @param nrbytes number of bytes in region
+ * @param bank    bank of the region, stored in the records
+ * @return uint16_t number of miscounts
+ */
+uint16_t fault_count_ram_bytes(char *memory, uint8_t val, uint16_t nrbytes, uint8_t bank);
+
+/**
+ * @brief Print the number of faults per data bit and per chip, followed by
+ *        the most recent records
+ */
+void fault_report(void);
+
+/**
+ * @brief Export the faults per data bit and per chip, followed by all
+ *        records in the ring buffer, oldest first (see serial.h)
+ */
+void fault_export(void);
+
+#endif // _FAULTMAP_H
@@ -0,0 +1,373 @@
+;-------------------------------------------------------------------------------
+;
+;   Author: Ivo Filot <ivo@ivofilot.nl>
+;
+;   P2000T-RAMTESTER is free software:
+;   you can redistribute it and/or modify it under the terms of the
+;   GNU General Public License as published by the Free Software
+;   Foundation, either version 3 of the License, or (at your option)
+;   any later version.
+;
+;   P2000T-RAMTESTER software is distributed in the hope that it will
+;   be useful, but WITHOUT ANY WARRANTY; without even the implied
+;   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+;   See the GNU General Public License for more details.
+;
+;   You should have received a copy of the GNU General Public License
+;   along with this program.  If not, see http://www.gnu.org/licenses/.
+;
+;-------------------------------------------------------------------------------
+
+SECTION code_user
+
+PUBLIC _fill_ram_bytes
+PUBLIC _fill_verify_ram_bytes
+PUBLIC _fill_verify_ram_bytes_desc
+PUBLIC _fill_bank_window
+
+;-------------------------------------------------------------------------------
+; void fill_ram_bytes(char *memory, uint8_t val, uint16_t nrbytes) __z88dk_callee;
+;
+; Fill a memory region with a single byte. The first byte is written directly
+; after which LDIR propagates it over the remainder of the region.
+;-------------------------------------------------------------------------------
+_fill_ram_bytes:
+    pop hl                      ; return address
+    pop de                      ; ramptr
+    dec sp                      ; decrement sp for 1-byte argument
+    pop af                      ; byte to write (stored in a)
+    pop bc                      ; number of bytes
+    push hl                     ; push return address back onto stack
+    ex de,hl                    ; hl = ramptr
+    ld e,a
+    ld a,b
+    or c
+    ret z                       ; nothing to write
+    ld (hl),e                   ; write first byte
+    dec bc
+    ld a,b
+    or c
+    ret z                       ; region was only a single byte
+    ld d,h
+    ld e,l
+    inc de
+    ldir                        ; propagate first byte over the region
+    ret
+
+;-------------------------------------------------------------------------------
+; uint16_t fill_verify_ram_bytes(char *memory, uint8_t verify, uint8_t fill,
+;                                uint16_t nrbytes) __z88dk_callee;
+; uint16_t fill_verify_ram_bytes_desc(char *memory, uint8_t verify, uint8_t fill,
+;                                     uint16_t nrbytes) __z88dk_callee;
+;
+; Single sweep over a memory region where every byte is first compared to
+; the verify byte and afterwards overwritten with the fill byte. Returns the
+; number of bytes that did not match the verify byte. This allows a test to
+; check pattern N while writing pattern N+1 in the same pass. The _desc
+; variant traverses the region from the last byte down to the first byte,
+; as required by the descending elements of a march test.
+;
+; The loop is unrolled eight times (37 T-states per byte) and is entered
+; at an offset when nrbytes is not divisible by eight. A separate memset and
+; count_ram_bytes pass costs about 45 T-states per byte and sweeps the region
+; twice.
+;-------------------------------------------------------------------------------
+_fill_verify_ram_bytes_desc:
+    ld a,1                      ; descending
+    jr fv_start
+_fill_verify_ram_bytes:
+    xor a                       ; ascending
+fv_start:
+    pop hl                      ; return address
+    pop de                      ; ramptr
+    pop bc                      ; c = verify byte, b = fill byte
+    ex (sp),hl                  ; hl = nrbytes, return address back on stack
+    push bc                     ; store verify and fill byte
+    ld bc,fv_loop
+    or a
+    jr z,fv_direction
+    ld bc,fvd_loop
+    ex de,hl
+    add hl,de
+    dec hl                      ; start at the last byte of the region
+    ex de,hl
+fv_direction:
+    ld (fv_entry),bc            ; store start of unrolled loop
+    pop bc
+    push de                     ; store ramptr
+    ld d,b                      ; d = fill byte
+    ld e,c                      ; e = verify byte
+    ld b,h
+    ld c,l                      ; bc = number of bytes
+    ld hl,0
+    ld (fv_miscount),hl         ; reset miscounter
+    ld a,b
+    or c
+    jr z,fv_empty               ; nothing to do
+    ld a,c
+    and 0x07                    ; number of bytes in partial block
+    srl b
+    rr c
+    srl b
+    rr c
+    srl b
+    rr c                        ; bc = number of full blocks
+    or a
+    jr z,fv_aligned
+    inc bc                      ; count partial block as well
+    neg
+    and 0x07                    ; number of cells to skip in first block
+    ld l,a
+    add a,a
+    add a,a
+    add a,a
+    sub l                       ; each cell occupies 7 bytes
+fv_aligned:
+    ld hl,(fv_entry)
+    add a,l                     ; hl = fv_entry + a
+    ld l,a
+    adc a,h
+    sub l
+    ld h,a
+    ex (sp),hl                  ; restore ramptr, put entry point on stack
+    ret                         ; jump into unrolled loop
+fv_loop:
+    ld a,(hl)
+    cp e
+    call nz,fv_miss
+    ld (hl),d
+    inc hl
+    ld a,(hl)
+    cp e
+    call nz,fv_miss
+    ld (hl),d
+    inc hl
+    ld a,(hl)
+    cp e
+    call nz,fv_miss
+    ld (hl),d
+    inc hl
+    ld a,(hl)
+    cp e
+    call nz,fv_miss
+    ld (hl),d
+    inc hl
+    ld a,(hl)
+    cp e
+    call nz,fv_miss
+    ld (hl),d
+    inc hl
+    ld a,(hl)
+    cp e
+    call nz,fv_miss
+    ld (hl),d
+    inc hl
+    ld a,(hl)
+    cp e
+    call nz,fv_miss
+    ld (hl),d
+    inc hl
+    ld a,(hl)
+    cp e
+    call nz,fv_miss
+    ld (hl),d
+    inc hl
+    dec bc
+    ld a,b
+    or c
+    jp nz,fv_loop
+    ld hl,(fv_miscount)         ; result is stored in hl
+    ret
+fvd_loop:
+    ld a,(hl)
+    cp e
+    call nz,fv_miss
+    ld (hl),d
+    dec hl
+    ld a,(hl)
+    cp e
+    call nz,fv_miss
+    ld (hl),d
+    dec hl
+    ld a,(hl)
+    cp e
+    call nz,fv_miss
+    ld (hl),d
+    dec hl
+    ld a,(hl)
+    cp e
+    call nz,fv_miss
+    ld (hl),d
+    dec hl
+    ld a,(hl)
+    cp e
+    call nz,fv_miss
+    ld (hl),d
+    dec hl
+    ld a,(hl)
+    cp e
+    call nz,fv_miss
+    ld (hl),d
+    dec hl
+    ld a,(hl)
+    cp e
+    call nz,fv_miss
+    ld (hl),d
+    dec hl
+    ld a,(hl)
+    cp e
+    call nz,fv_miss
+    ld (hl),d
+    dec hl
+    dec bc
+    ld a,b
+    or c
+    jp nz,fvd_loop
+    ld hl,(fv_miscount)         ; result is stored in hl
+    ret
+fv_empty:
+    pop de                      ; discard ramptr, hl = 0
+    ret
+fv_miss:
+    push hl
+    ld hl,(fv_miscount)
+    inc hl
+    ld (fv_miscount),hl
+    pop hl
+    ret
+
+;-------------------------------------------------------------------------------
+; void fill_bank_window(uint16_t pattern16) __z88dk_fastcall;
+;
+; Fill the bank window 0xE000-0xFFFF with a 16-bit pattern; the low byte of
+; the pattern ends up at the even addresses and the high byte at the odd
+; addresses. The stack pointer is temporarily set to the end of the window
+; after which the pattern is written using unrolled PUSH instructions:
+; 717 T-states per 128 bytes or about 46,000 T-states (~18 ms) per bank
+; compared to 172,000 T-states for an LDIR based fill.
+;
+; Interrupts are disabled while SP points into the window such that the
+; interrupt routine cannot push onto the bank, the original stack pointer is
+; kept in RAM and the interrupt state is restored on exit. After every KiB
+; the original stack pointer is restored for a moment and a pending
+; interrupt is accepted, such that the interrupt routine is delayed by at
+; most ~2.3 ms rather than the full 18 ms of the fill (~100 T-states per
+; KiB). This assumes the interrupt request stays asserted until accepted, as
+; in p2ksim; if it does not on a P2000T, the tick is lost instead. Callers must not run with the stack in the bank window, as no fill
+; can avoid overwriting the live stack and return address; in that case the
+; routine returns without writing.
+;-------------------------------------------------------------------------------
+_fill_bank_window:
+    ex de,hl                    ; de = pattern
+    ld hl,0
+    add hl,sp                   ; hl = current stack pointer
+    ld a,h
+    cp 0xE0
+    ret nc                      ; stack lives in the bank window, refuse
+    ld a,i                      ; p/v = interrupt state
+    di
+    push af                     ; store interrupt state on the real stack
+    ld (fbw_sp),sp
+    ld sp,0x0000                ; first push writes to 0xFFFE and 0xFFFF
+    ld c,8                      ; 8 x 1 KiB
+fbw_chunk:
+    ld b,8                      ; 8 x 128 bytes = 1 KiB
+fbw_loop:
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    push de
+    djnz fbw_loop
+    dec c
+    jr z,fbw_done
+    ld (fbw_ptr),sp             ; leave the window for a pending interrupt
+    ld sp,(fbw_sp)
+    pop af
+    push af
+    jp po,fbw_resume            ; interrupts were disabled upon entry
+    ei
+    nop                         ; a pending interrupt is accepted here
+    di
+fbw_resume:
+    ld sp,(fbw_ptr)
+    jr fbw_chunk
+fbw_done:
+    ld sp,(fbw_sp)              ; restore stack pointer
+    pop af
+    ret po                      ; interrupts were disabled upon entry
+    ei
+    ret
+
+SECTION bss_user
+
+fv_miscount:
+    defs 2
+
+fv_entry:
+    defs 2
+
+fbw_sp:
+    defs 2
+
+fbw_ptr:
+    defs 2
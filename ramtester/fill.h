@@ -0,0 +1,74 @@
+/**************************************************************************
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   P2000T-RAMTESTER is free software:                                   *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   P2000T-RAMTESTER software is distributed in the hope that it will    *
+ *   be useful, but WITHOUT ANY WARRANTY; without even the implied        *
+ *   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#ifndef _FILL_H
+#define _FILL_H
+
+#include <stdint.h>
+
+// replicate a single byte into a 16-bit pattern for fill_bank_window
+#define PATTERN16(x) ((((uint16_t)(x)) << 8) | (uint8_t)(x))
+
+/**
+ * @brief Fill a memory region with a single byte
+ *
+ * @param memory  pointer to start of region
+ * @param val     byte to write
+ * @param nrbytes number of bytes in region
+ */
+void fill_ram_bytes(char *memory, uint8_t val, uint16_t nrbytes) __z88dk_callee;
+
+/**
+ * @brief Verify that a memory region holds a byte and overwrite it with
+ *        another byte in the same sweep
+ *
+ * @param memory  pointer to start of region
+ * @param verify  byte expected in the region
+ * @param fill    byte written to the region
+ * @param nrbytes number of bytes in region
+ * @return uint16_t number of bytes not matching verify
+ */
+uint16_t fill_verify_ram_bytes(char *memory, uint8_t verify, uint8_t fill,
+                               uint16_t nrbytes) __z88dk_callee;
+
+/**
+ * @brief Same as fill_verify_ram_bytes, but traverses the memory region from
+ *        the last byte down to the first byte
+ *
+ * @param memory  pointer to start of region
+ * @param verify  byte expected in the region
+ * @param fill    byte written to the region
+ * @param nrbytes number of bytes in region
+ * @return uint16_t number of bytes not matching verify
+ */
+uint16_t fill_verify_ram_bytes_desc(char *memory, uint8_t verify, uint8_t fill,
+                                    uint16_t nrbytes) __z88dk_callee;
+
+/**
+ * @brief Fill the bank window 0xE000-0xFFFF using the stack pointer, the low
+ *        byte of the pattern is written to the even addresses and the high
+ *        byte to the odd addresses; the window is left untouched when
+ *        the stack pointer lies within it, which callers must avoid
+ *
+ * @param pattern16 16-bit pattern
+ */
+void fill_bank_window(uint16_t pattern16) __z88dk_fastcall;
+
+#endif // _FILL_H
@@ -0,0 +1,153 @@
+/**************************************************************************
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   P2000T-RAMTESTER is free software:                                   *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   P2000T-RAMTESTER software is distributed in the hope that it will    *
+ *   be useful, but WITHOUT ANY WARRANTY; without even the implied        *
+ *   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#include "format.h"
+#include "constants.h"
+
+char* fmt_ptr = 0;
+
+static const char _fmt_hexdigits[] = "0123456789ABCDEF";
+static const uint16_t _fmt_pow10[] = {10000, 1000, 100, 10};
+static const uint32_t _fmt_pow10_32[] = {1000000000, 100000000, 10000000, 1000000, 100000};
+
+void fmt_at(char* dst) {
+    fmt_ptr = dst;
+}
+
+void fmt_char(char c) {
+    *fmt_ptr++ = c;
+}
+
+void fmt_str(const char* str) {
+    char* p = fmt_ptr;
+    while(*str != 0) {
+        *p++ = *str++;
+    }
+    fmt_ptr = p;
+}
+
+void fmt_color(uint8_t color, const char* str) {
+    *fmt_ptr++ = color;
+    fmt_str(str);
+    *fmt_ptr++ = COL_WHITE;
+}
+
+void fmt_hex8(uint8_t val) {
+    char* p = fmt_ptr;
+    p[0] = _fmt_hexdigits[val >> 4];
+    p[1] = _fmt_hexdigits[val & 0x0F];
+    fmt_ptr = p + 2;
+}
+
+void fmt_hex16(uint16_t val) {
+    fmt_hex8((uint8_t)(val >> 8));
+    fmt_hex8((uint8_t)val);
+}
+
+/*
+ * Digits are obtained by repeated subtraction of powers of ten, which avoids
+ * pulling the 16-bit division routines into the binary.
+ */
+void fmt_dec(uint16_t val, uint8_t width) {
+    char digits[5];
+    uint8_t n = 0;
+
+    for(uint8_t i=0; i<sizeof(_fmt_pow10) / sizeof(_fmt_pow10[0]); i++) {
+        uint8_t d = 0;
+        while(val >= _fmt_pow10[i]) {
+            val -= _fmt_pow10[i];
+            d++;
+        }
+        if(d != 0 || n != 0) {
+            digits[n++] = '0' + d;
+        }
+    }
+    digits[n++] = '0' + (uint8_t)val;
+
+    char* p = fmt_ptr;
+    for(; width > n; width--) {
+        *p++ = ' ';
+    }
+    for(uint8_t i=0; i<n; i++) {
+        *p++ = digits[i];
+    }
+    fmt_ptr = p;
+}
+
+/*
+ * Values beyond 16 bits have at least five digits; the digits above these
+ * are obtained by subtraction of 32-bit powers of ten.
+ */
+void fmt_dec32(uint32_t val, uint8_t width) {
+    if(val <= 0xFFFF) {
+        fmt_dec((uint16_t)val, width);
+        return;
+    }
+
+    char* p = fmt_ptr;
+    char digits[5];
+    uint8_t n = 0;
+    for(uint8_t i=0; i<sizeof(_fmt_pow10_32) / sizeof(_fmt_pow10_32[0]); i++) {
+        uint8_t d = 0;
+        while(val >= _fmt_pow10_32[i]) {
+            val -= _fmt_pow10_32[i];
+            d++;
+        }
+        if(d != 0 || n != 0) {
+            digits[n++] = '0' + d;
+        }
+    }
+
+    // the remaining five digits are written in full
+    for(; width > n + 5; width--) {
+        *p++ = ' ';
+    }
+    for(uint8_t i=0; i<n; i++) {
+        *p++ = digits[i];
+    }
+    for(uint8_t i=0; i<sizeof(_fmt_pow10) / sizeof(_fmt_pow10[0]); i++) {
+        uint8_t d = 0;
+        while(val >= _fmt_pow10[i]) {
+            val -= _fmt_pow10[i];
+            d++;
+        }
+        *p++ = '0' + d;
+    }
+    *p++ = '0' + (uint8_t)val;
+    fmt_ptr = p;
+}
+
+void fmt_dec2(uint8_t val) {
+    uint8_t tens = 0;
+    while(val >= 10) {
+        val -= 10;
+        tens++;
+    }
+    fmt_ptr[0] = '0' + tens;
+    fmt_ptr[1] = '0' + val;
+    fmt_ptr += 2;
+}
+
+void fmt_pad(char* start, uint8_t width) {
+    char* end = start + width;
+    while(fmt_ptr < end) {
+        *fmt_ptr++ = ' ';
+    }
+}
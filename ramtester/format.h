@@ -0,0 +1,112 @@
+/**************************************************************************
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   P2000T-RAMTESTER is free software:                                   *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   P2000T-RAMTESTER software is distributed in the hope that it will    *
+ *   be useful, but WITHOUT ANY WARRANTY; without even the implied        *
+ *   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#ifndef _FORMAT_H
+#define _FORMAT_H
+
+#include <stdint.h>
+
+/*
+ * Minimal replacement for sprintf. Every emitter writes at the position of
+ * a global cursor and advances it; no terminating zero is written, such that
+ * text can be composed directly into video memory. The cursor is typically
+ * positioned at the start of a terminal line by terminal_beginline().
+ */
+
+extern char* fmt_ptr;
+
+/**
+ * @brief Set the position at which the next character is written
+ *
+ * @param dst destination
+ */
+void fmt_at(char* dst);
+
+/**
+ * @brief Write a single character or control code (e.g. a color)
+ *
+ * @param c character
+ */
+void fmt_char(char c);
+
+/**
+ * @brief Write a zero-terminated string (without the terminating zero)
+ *
+ * @param str string
+ */
+void fmt_str(const char* str);
+
+/**
+ * @brief Write a string surrounded by a color code and COL_WHITE
+ *
+ * @param color color code
+ * @param str   string
+ */
+void fmt_color(uint8_t color, const char* str);
+
+/**
+ * @brief Write a byte as two uppercase hexadecimal digits (%02X)
+ *
+ * @param val value
+ */
+void fmt_hex8(uint8_t val);
+
+/**
+ * @brief Write a word as four uppercase hexadecimal digits (%04X)
+ *
+ * @param val value
+ */
+void fmt_hex16(uint16_t val);
+
+/**
+ * @brief Write an unsigned value in decimal, right aligned in a field of at
+ *        least width characters (%<width>u); use width 0 for no padding
+ *
+ * @param val   value
+ * @param width minimal field width
+ */
+void fmt_dec(uint16_t val, uint8_t width);
+
+/**
+ * @brief Write an unsigned 32-bit value in decimal, right aligned in a field
+ *        of at least width characters (%<width>lu)
+ *
+ * @param val   value
+ * @param width minimal field width
+ */
+void fmt_dec32(uint32_t val, uint8_t width);
+
+/**
+ * @brief Write a value below 100 as two decimal digits (%02u)
+ *
+ * @param val value
+ */
+void fmt_dec2(uint8_t val);
+
+/**
+ * @brief Pad with spaces until the cursor is width characters past start
+ *        (used for left aligned fields, %-<width>s)
+ *
+ * @param start start of the field
+ * @param width field width
+ */
+void fmt_pad(char* start, uint8_t width);
+
+#endif // _FORMAT_H
@@ -0,0 +1,75 @@
+;-------------------------------------------------------------------------------
+;
+;   Author: Ivo Filot <ivo@ivofilot.nl>
+;
+;   P2000T-RAMTESTER is free software:
+;   you can redistribute it and/or modify it under the terms of the
+;   GNU General Public License as published by the Free Software
+;   Foundation, either version 3 of the License, or (at your option)
+;   any later version.
+;
+;   P2000T-RAMTESTER software is distributed in the hope that it will
+;   be useful, but WITHOUT ANY WARRANTY; without even the implied
+;   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+;   See the GNU General Public License for more details.
+;
+;   You should have received a copy of the GNU General Public License
+;   along with this program.  If not, see http://www.gnu.org/licenses/.
+;
+;-------------------------------------------------------------------------------
+
+SECTION code_user
+
+PUBLIC _isr_install
+
+EXTERN _serial_isr
+EXTERN _progress_isr
+
+defc ISR_TABLE = 0x6E00         ; must match memory.h
+defc ISR_JUMP = 0x6F6F          ; every entry of the table points here
+defc MONITOR_ISR = 0x0038       ; IM 1 handler of the monitor
+
+;-------------------------------------------------------------------------------
+; void isr_install(void);
+;
+; Switch to interrupt mode 2 with a handler that runs the hooks of the RAM
+; tester before chaining to the interrupt handler of the monitor, which keeps
+; counting ticks and scanning the keyboard.
+;
+; The vector table consists of 257 identical bytes, such that the vector is
+; found at ISR_JUMP irrespective of the value on the data bus during the
+; interrupt acknowledge. ISR_JUMP holds a jump to the handler.
+;-------------------------------------------------------------------------------
+_isr_install:
+    di
+    ld hl,ISR_TABLE
+    ld de,ISR_TABLE+1
+    ld bc,256
+    ld (hl),ISR_JUMP/256
+    ldir                        ; fill 257 bytes with the vector high byte
+    ld a,0xC3                   ; jp nn
+    ld (ISR_JUMP),a
+    ld hl,isr_entry
+    ld (ISR_JUMP+1),hl
+    ld a,ISR_TABLE/256
+    ld i,a
+    im 2
+    ei
+    ret
+
+;-------------------------------------------------------------------------------
+; Interrupt handler; the hooks may use af, bc, de and hl. The monitor saves
+; its own registers and returns from the interrupt.
+;-------------------------------------------------------------------------------
+isr_entry:
+    push af
+    push bc
+    push de
+    push hl
+    call _serial_isr
+    call _progress_isr
+    pop hl
+    pop de
+    pop bc
+    pop af
+    jp MONITOR_ISR
@@ -0,0 +1,41 @@
+/**************************************************************************
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   P2000T-RAMTESTER is free software:                                   *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   P2000T-RAMTESTER software is distributed in the hope that it will    *
+ *   be useful, but WITHOUT ANY WARRANTY; without even the implied        *
+ *   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#ifndef _INTERRUPT_H
+#define _INTERRUPT_H
+
+/*
+ * The RAM tester runs its own interrupt handler in interrupt mode 2, which
+ * calls the hooks below and subsequently jumps into the interrupt handler of
+ * the monitor. The vector table occupies ISR_TABLE - ISR_TABLE + 0x100 and
+ * the jump into the handler 0x6F6F - 0x6F71 (see memory.h), between the end
+ * of the data segment and the lower memory overwritten by test 4.
+ *
+ * Hooks (interrupt.asm):
+ *   serial_isr   transmits buffered result records, see serial.h
+ *   progress_isr redraws the status line while a test runs, see progress.h
+ */
+
+/**
+ * @brief Install the interrupt handler and enable interrupts
+ */
+void isr_install(void);
+
+#endif // _INTERRUPT_H
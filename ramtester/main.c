@@ -29,7 +29,6 @@
 
 #include <string.h>
 #include <stdint.h>
-#include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
 
@@ -40,8 +39,19 @@
 #include "stack.h"
 #include "z80.h"
 #include "ramtest.h"
+#include "fill.h"
 #include "terminal.h"
+#include "format.h"
+#include "bankgrid.h"
+#include "faultmap.h"
 #include "bankcounting.h"
+#include "march.h"
+#include "timing.h"
+#include "serial.h"
+#include "profile.h"
+#include "progress.h"
+#include "registry.h"
+#include "soak.h"
 
 #define MEMEXPNONE  0       // no expansion
 #define MEMEXP16    1       // A000-DFFF, no banking
@@ -54,52 +64,79 @@
 #define MEMEXP1056  8
 #define MEMEXP2080  9
 
-uint8_t test_passed[5];
+#define STRIPE_BYTES 16     // bytes sampled per 256-byte page by test 10
+#define COPY_STEP   0x400   // shift of the cartridge window between banks in test 12
+#define COPY_WINDOWS 8      // number of distinct cartridge windows in test 12
+#define PROBE_BYTES 14      // bytes probed per bank by test 14
+
+uint16_t test_passed[NR_CHECKS];
 
 // forward declarations
 void init(void);
 
-void set_bank_highmem(uint8_t bank);
-
 uint8_t read_bank(void);
 
 void ram_test_01(void);
 void ram_test_02(void);
-void ram_test_03(void);
-void ram_test_04(void);
-void ram_test_05(void);
-void ram_test_06(void);
-void ram_test_07(void);
+
+#define SWEEP_WRITE     0x01    // write fill byte to banks
+#define SWEEP_VERIFY    0x02    // verify banks against verify byte
 
 uint8_t test_bank_helper(uint8_t startbank, uint8_t stopbank, uint8_t *uppermembanks,
                          uint8_t *expansion_type, uint8_t banktypefail, uint16_t szdetect);
-void test_fixed_pattern(uint8_t pattern, uint8_t check_id);
-void write_termbuffer_value(uint8_t i, uint8_t color);
+uint16_t test_region_patterns(char *region, uint16_t nrbytes, uint8_t bank);
+void test_tag_sweep(void);
+void test_pattern_sweep(uint8_t verify, uint8_t fill, uint8_t check_id, uint8_t mode);
+void write_region_result(uint16_t start, uint16_t stop, uint8_t bank, uint16_t miscounts);
+void stripe_fill(char *region, uint8_t nrpages, uint8_t val);
+uint16_t stripe_count(char *region, uint8_t nrpages, uint8_t val, uint8_t bank);
+void export_results(void);
+void write_seed_failure(uint16_t bank, uint16_t seed, uint16_t miscounts);
+uint16_t count_copy_errors(const char *copy, const char *source, uint16_t nrbytes);
 static uint8_t fingerprint(uint8_t i) { return (uint8_t)(0xA5u ^ i); }
+static uint16_t lfsr_seed(uint16_t seed, uint8_t i) { return seed + (uint16_t)i * 0x0101; }
+static const char* copy_window(uint8_t i) { return &memory[CARTRIDGE_START + (i % COPY_WINDOWS) * COPY_STEP]; }
+static uint16_t probe_offset(uint8_t k) { return k == 0 ? 0 : (uint16_t)1 << (k - 1); }
+uint8_t bank_register_mask(void);
+uint8_t bus_walk_port(uint8_t mask);
+uint8_t bus_walk_memory(volatile uint8_t *p);
+void write_bus_result(const char *name, uint8_t failed);
+
+// checkerboard and stuck-at patterns
+static const uint8_t test_patterns[] = {0x55, 0xAA, 0x00, 0xFF};
+
+// test 10 writes tags and fingerprints as is and inverted
+static const uint8_t stripe_inversions[] = {0x00, 0xFF};
 
 // global variables
 uint8_t expansion_type = 0;
 uint8_t highmemsectors = 0;       // number of high memory sectors
 uint8_t highmembanks = 0;         // number of high memory banks
 uint16_t uppermembanks = 0;       // number of upper memory banks
+bankaddr_t highbank_selector = 0; // selector of the second high memory bank
+uint8_t profile = PROFILE_STANDARD;
 
+#ifndef BENCH
 int main(void) {
     init();
 
     // reset passed tests array
-    memset(test_passed, 0x00, 5);
+    memset(test_passed, 0x00, sizeof(test_passed));
 
     // perform test on high memory
-    ram_test_01();
+    run_test(1, ram_test_01, 0);
 
     // if there are no high memory banks, stop here
     if(highmemsectors != 0) {
-        ram_test_02();        
-        ram_test_03();
-        ram_test_04();
-        ram_test_05();
-        ram_test_06();
-        ram_test_07();
+        run_test(2, ram_test_02, 0);
+
+        profile = profile_select(uppermembanks, highmembanks);
+        serial_begin('P');
+        serial_field_str(profiles[profile].name);
+        serial_end();
+
+        registry_run(profiles[profile].tests, profiles[profile].full,
+                     uppermembanks, highmembanks);
     }
 
     print_info("",0);   // print empty line
@@ -108,22 +145,53 @@ int main(void) {
     // show summary
     print_info("",0);   // print empty line
     print_inline_color("-= SUMMARY =-", COL_CYAN);
-    char buf[50];
-    for(uint8_t i=0; i<5; i++) {
+    for(uint8_t i=0; i<NR_CHECKS; i++) {
+        if(!(checks_run & CHECK_BIT(i))) {
+            continue;
+        }
+        terminal_beginline();
+        fmt_str("  * CHECK ");
+        fmt_dec(i+1, 0);
+        fmt_str(": ");
         if(test_passed[i] == 0) {
-            sprintf(buf, "  * TEST %u: %cPASSED%c", i+1, COL_GREEN, COL_WHITE);
-            print_info(buf, 0);
+            fmt_color(COL_GREEN, "PASSED");
         } else {
-            sprintf(buf, "  * TEST %u: %cFAILED%c; %u ERROR(S) ENCOUNTERED", i+1, COL_RED, COL_WHITE, test_passed[i]);
-            print_info(buf, 0);
+            fmt_color(COL_RED, "FAILED");
+            fmt_str("; ");
+            fmt_dec(test_passed[i], 0);
+            fmt_str(" ERROR(S) ENCOUNTERED");
+        }
+        terminal_newline();
+    }
+
+    // show elapsed time and throughput per test
+    print_info("",0);   // print empty line
+    print_inline_color("-= TIMING =-", COL_CYAN);
+    timing_report();
+
+    // show failing bits and chips
+    if(fault_total != 0) {
+        print_info("",0);   // print empty line
+        print_inline_color("-= FAULTS =-", COL_CYAN);
+        fault_report();
+    }
+    bank_status_render();
+
+    // send the results to the host, see collect.py
+    export_results();
+
+    // loop the tests on request for burn-in, which does not return
+    if(highmemsectors != 0) {
+        print_info("Press a key within 10 s for burn-in", 0);
+        if(wait_for_key_ticks(SOAK_TIMEOUT)) {
+            soak_run(uppermembanks, highmembanks, highbank_selector);
         }
-        
     }
-    write_stack_pointer();
 
     // put in infinite loop
     for(;;){}
 }
+#endif // BENCH
 
 /*
  * Test 1: Test high memory
@@ -134,6 +202,7 @@ int main(void) {
  */
 void ram_test_01(void) {
     print_info("Test 1: High memory", 0);
+    terminal_beginline();
     for(uint8_t i=0xA; i<=0xD; i++) {
 
         memory[i * 0x1000] = 0x55;
@@ -146,13 +215,15 @@ void ram_test_01(void) {
         }
 
         if(memory[i * 0x1000] == 0x55) {
-            sprintf(&termbuffer[(i - 0xA)*6], "%c%04X%c", COL_GREEN, i * 0x1000, COL_WHITE);
+            fmt_char(COL_GREEN);
             highmemsectors++;
         } else {
-            sprintf(&termbuffer[(i - 0xA)*6], "%c%04X%c", COL_RED, i * 0x1000, COL_WHITE);
+            fmt_char(COL_RED);
         }
+        fmt_hex16(i * 0x1000);
+        fmt_char(COL_WHITE);
     }
-    terminal_printtermbuffer();
+    terminal_newline();
 
     if(highmemsectors == 0) {
         expansion_type = 0;
@@ -173,8 +244,12 @@ void ram_test_01(void) {
 void ram_test_02(void) {
     print_info("Test 2: Determine number of RAM banks", 0);
     uppermembanks = count_banks();
-    sprintf(termbuffer, "%c%u%c RAM banks found", COL_CYAN, uppermembanks, COL_WHITE);
-    terminal_printtermbuffer();
+    terminal_beginline();
+    fmt_char(COL_CYAN);
+    fmt_dec(uppermembanks, 0);
+    fmt_char(COL_WHITE);
+    fmt_str(" RAM banks found");
+    terminal_newline();
 
     switch(uppermembanks) {
         case 0:
@@ -208,6 +283,34 @@ void ram_test_02(void) {
             print_inline_color("Unknown memory expansion, please inform developer", COL_RED);
         break;
     }
+
+    // probe for a second 16 KiB bank on 0xA000-0xDFFF, which is selected via
+    // port 0x95 on the 2080 KiB board and via bit 7 of port 0x94 on the
+    // 1056 KiB board (only when bit 7 does not address an 8 KiB bank); port
+    // 0x95 is left alone on boards with fewer banks than the 2080 KiB board
+    highmembanks = 1;
+    if(uppermembanks >= LOW_SELECTORS && probe_highmem_bank(HIGHBANK_2080)) {
+        highbank_selector = HIGHBANK_2080;
+        highmembanks = 2;
+    } else if(uppermembanks <= HIGHBANK_1056 && probe_highmem_bank(HIGHBANK_1056)) {
+        highbank_selector = HIGHBANK_1056;
+        highmembanks = 2;
+    }
+    terminal_beginline();
+    fmt_char(COL_CYAN);
+    fmt_dec(highmembanks, 0);
+    fmt_char(COL_WHITE);
+    fmt_str(" high memory banks found");
+    terminal_newline();
+
+    serial_begin('B');
+    serial_field_dec(uppermembanks);
+    serial_field_dec(highmembanks);
+    serial_end();
+
+    // the banks are shown in a grid below the terminal from here on
+    bankgrid_init(uppermembanks);
+    fault_init(uppermembanks);
 }
 
 /*
@@ -215,24 +318,31 @@ void ram_test_02(void) {
 * =============================
 *
 * Final quick test where a value is written to the bank register to swap
-* the bank and check whether that value can be read back.
+* the bank and check whether that value can be read back. Only the lines that
+* select one of the detected banks are compared, as in test 13.
 */
 void ram_test_03(void) {
     print_info("Test 3: Reading bank register", 0);
+    uint8_t mask = bank_register_mask();
     uint16_t bankschecked = 0;
     for(uint16_t i=0; i<uppermembanks; i++) {
-        set_bank(i);
+        bank_select(i);
         
-        if(read_bank() == i) {
+        if(((read_bank() ^ (uint8_t)i) & mask) == 0) {
             bankschecked++;
+        } else {
+            test_passed[CHECK_BANKREG]++;
         }
     }
+    terminal_beginline();
+    fmt_str("  ");
     if(bankschecked == uppermembanks) {
-        sprintf(termbuffer, "  %cOK%c Reading bank register", COL_GREEN, COL_WHITE);
+        fmt_color(COL_GREEN, "OK");
     } else {
-        sprintf(termbuffer, "  %cFAIL%c Reading bank register", COL_RED, COL_WHITE);
+        fmt_color(COL_RED, "FAIL");
     }
-    terminal_printtermbuffer();
+    fmt_str(" Reading bank register");
+    terminal_newline();
 }
 
 /*
@@ -245,37 +355,23 @@ void ram_test_03(void) {
 void ram_test_04(void) {
     set_bank(0);
     print_info("Test 4: Lower and higher memory", 0);
-    memset(&memory[LOWMEM], 0x55, STACK - LOWMEM);
-    uint16_t lowmem_count = count_ram_bytes(&memory[LOWMEM], 0x55, STACK - LOWMEM);
-    memset(&memory[LOWMEM], 0xAA, STACK - LOWMEM);
-    lowmem_count += count_ram_bytes(&memory[LOWMEM], 0xAA, STACK - LOWMEM);
-    memset(&memory[LOWMEM], 0x00, STACK - LOWMEM);
-    lowmem_count += count_ram_bytes(&memory[LOWMEM], 0x00, STACK - LOWMEM);
-    memset(&memory[LOWMEM], 0xFF, STACK - LOWMEM);
-    lowmem_count += count_ram_bytes(&memory[LOWMEM], 0xFF, STACK - LOWMEM);
-
-    if(lowmem_count == 0) {
-        sprintf(termbuffer, "  0x%04X - 0x%04X: %cOK", LOWMEM, STACK-1, COL_GREEN);
-    } else {
-        sprintf(termbuffer, "  0x%04X - 0x%04X: %c%u miscounts", LOWMEM, STACK-1, COL_RED, lowmem_count);
+    uint16_t lowmem_count = test_region_patterns(&memory[LOWMEM], STACK - LOWMEM, 0);
+
+    write_region_result(LOWMEM, STACK-1, 0xFF, lowmem_count);
+    if(lowmem_count != 0) {
+        test_passed[CHECK_REGION]++;
     }
-    terminal_printtermbuffer();
 
-    memset(&memory[HIGHMEM_START], 0x55, HIGHMEM_STOP - HIGHMEM_START - 1);
-    uint16_t uppermem_count = count_ram_bytes(&memory[HIGHMEM_START], 0x55, HIGHMEM_STOP - HIGHMEM_START);
-    memset(&memory[HIGHMEM_START], 0xAA, HIGHMEM_STOP - HIGHMEM_START - 1);
-    uppermem_count += count_ram_bytes(&memory[HIGHMEM_START], 0xAA, HIGHMEM_STOP - HIGHMEM_START);
-    memset(&memory[HIGHMEM_START], 0x00, HIGHMEM_STOP - HIGHMEM_START - 1);
-    uppermem_count += count_ram_bytes(&memory[HIGHMEM_START], 0x00, HIGHMEM_STOP - HIGHMEM_START);
-    memset(&memory[HIGHMEM_START], 0xFF, HIGHMEM_STOP - HIGHMEM_START - 1);
-    uppermem_count += count_ram_bytes(&memory[HIGHMEM_START], 0xFF, HIGHMEM_STOP - HIGHMEM_START);
+    for(uint8_t i=0; i<highmembanks; i++) {
+        set_bank(i == 0 ? 0 : highbank_selector);
+        uint16_t uppermem_count = test_region_patterns(&memory[HIGHMEM_START], HIGHMEM_STOP - HIGHMEM_START + 1, i);
 
-    if(uppermem_count == 0) {
-        sprintf(termbuffer, "  0x%04X - 0x%04X: %cOK", HIGHMEM_START, HIGHMEM_STOP, COL_GREEN);
-    } else {
-        sprintf(termbuffer, "  0x%04X - 0x%04X: %c%u miscounts", HIGHMEM_START, HIGHMEM_STOP, COL_RED, uppermem_count);
+        write_region_result(HIGHMEM_START, HIGHMEM_STOP, i, uppermem_count);
+        if(uppermem_count != 0) {
+            test_passed[CHECK_REGION]++;
+        }
     }
-    terminal_printtermbuffer();
+    set_bank(0);
 }
 
 /*
@@ -291,41 +387,43 @@ void ram_test_05(void) {
     for(uint16_t i=0; i<uppermembanks; i++) {
         set_bank(i);
         uint8_t t = tag_byte(0x00, (uint8_t)i);
-        memset(&memory[BANKMEM_START], t, BANKMEM_STOP - BANKMEM_START + 1);
-        write_termbuffer_value((uint8_t)i, COL_CYAN);
-
-        if((i+1) % 8 == 0) {
-            terminal_printtermbuffer();
-        }
+        fill_bank_window(PATTERN16(t));
+        timing_add_bytes(BANK_BYTES);
+        bankgrid_set((uint8_t)i, BANKGRID_WRITTEN);
     }
 
-    // also print result when total is not divisible by 8
-    if(uppermembanks % 8 != 0) {
-        terminal_printtermbuffer();
-    }
+    test_tag_sweep();
+}
 
-    print_info("  Testing data on banks", 0);
+/*
+ * Test 16: Bank pipeline
+ * ======================
+ *
+ * Alternative for tests 5-7 where every bank is selected only once to run the
+ * checkerboard and stuck-at patterns, after which the bank is tagged. A final
+ * read-only sweep over all banks checks the tags, verifying that memory is
+ * conserved upon bank switching. Used by the PIPELINE profile.
+ */
+void ram_test_pipeline(void) {
+    print_info("Test 16: Bank pipeline", 0);
+    print_info("  Testing patterns, writing tags", 0);
 
     for(uint16_t i=0; i<uppermembanks; i++) {
         set_bank(i);
-        uint8_t t = tag_byte(0x00, (uint8_t)i);
-        uint16_t miscounts = count_ram_bytes(&memory[BANKMEM_START], t, BANKMEM_STOP - BANKMEM_START + 1);
-        if(miscounts == 0) {
-            write_termbuffer_value(i, COL_GREEN);
-        } else {
-            write_termbuffer_value((uint8_t)i, COL_RED);
-            test_passed[0]++;
-        }
-
-        if((i+1) % 8 == 0) {
-            terminal_printtermbuffer();
+        uint8_t failed = FALSE;
+        for(uint8_t j=0; j<sizeof(test_patterns); j++) {
+            fill_bank_window(PATTERN16(test_patterns[j]));
+            if(fault_count_ram_bytes(&memory[BANKMEM_START], test_patterns[j], BANK_BYTES, (uint8_t)i) != 0) {
+                test_passed[CHECK_PATTERN_55 + j]++;
+                failed = TRUE;
+            }
         }
+        fill_bank_window(PATTERN16(tag_byte(0x00, (uint8_t)i)));
+        timing_add_bytes((uint32_t)BANK_BYTES * (2 * sizeof(test_patterns) + 1));
+        bankgrid_set((uint8_t)i, failed ? BANKGRID_FAIL : BANKGRID_WRITTEN);
     }
 
-    // also print result when total is not divisible by 8
-    if(uppermembanks % 8 != 0) {
-        terminal_printtermbuffer();
-    }
+    test_tag_sweep();
 }
 
 /*
@@ -336,8 +434,9 @@ void ram_test_05(void) {
  */
 void ram_test_06(void) {   
     print_info("Test 6: Checkerboard test", 0);
-    test_fixed_pattern(0x55, 1);
-    test_fixed_pattern(0xAA, 2);
+    test_pattern_sweep(0x00, 0x55, CHECK_PATTERN_55, SWEEP_WRITE);
+    test_pattern_sweep(0x55, 0xAA, CHECK_PATTERN_55, SWEEP_VERIFY | SWEEP_WRITE);
+    test_pattern_sweep(0xAA, 0x00, CHECK_PATTERN_AA, SWEEP_VERIFY);
 }
 
 /*
@@ -348,12 +447,360 @@ void ram_test_06(void) {
  */
 void ram_test_07(void) {   
     print_info("Test 7: Stuck at transition", 0);
-    test_fixed_pattern(0x00, 3);
-    test_fixed_pattern(0xFF, 4);
+    test_pattern_sweep(0x00, 0x00, CHECK_PATTERN_00, SWEEP_WRITE);
+    test_pattern_sweep(0x00, 0xFF, CHECK_PATTERN_00, SWEEP_VERIFY | SWEEP_WRITE);
+    test_pattern_sweep(0xFF, 0x00, CHECK_PATTERN_FF, SWEEP_VERIFY);
+}
+
+/*
+ * Test 8: Address in address
+ * ==========================
+ *
+ * Write a value unique to every address, derived from the address and the
+ * bank number, to upper memory and to all banks. This detects faults on the
+ * address lines of the memory chips, which go unnoticed when a bank is
+ * filled with a constant value.
+ */
+void ram_test_08(void) {
+    print_info("Test 8: Address in address", 0);
+
+    for(uint8_t i=0; i<highmembanks; i++) {
+        set_bank(i == 0 ? 0 : highbank_selector);
+        fill_addr_pattern(&memory[HIGHMEM_START], fingerprint(i), HIGHMEM_PAGES);
+        uint16_t miscounts = count_addr_pattern(&memory[HIGHMEM_START], fingerprint(i), HIGHMEM_PAGES);
+        timing_add_bytes(2 * (HIGHMEM_STOP - HIGHMEM_START + 1));
+
+        write_region_result(HIGHMEM_START, HIGHMEM_STOP, i, miscounts);
+        if(miscounts != 0) {
+            test_passed[CHECK_ADDR]++;
+        }
+    }
+
+    print_info("  Writing data to banks", 0);
+
+    for(uint16_t i=0; i<uppermembanks; i++) {
+        set_bank(i);
+        fill_addr_pattern(&memory[BANKMEM_START], fingerprint((uint8_t)i), BANK_PAGES);
+        timing_add_bytes(BANK_BYTES);
+        bankgrid_set((uint8_t)i, BANKGRID_WRITTEN);
+    }
+
+    print_info("  Testing data on banks", 0);
+
+    for(uint16_t i=0; i<uppermembanks; i++) {
+        set_bank(i);
+        uint16_t miscounts = count_addr_pattern(&memory[BANKMEM_START], fingerprint((uint8_t)i), BANK_PAGES);
+        timing_add_bytes(BANK_BYTES);
+        if(miscounts == 0) {
+            bankgrid_set((uint8_t)i, BANKGRID_PASS);
+        } else {
+            bankgrid_set((uint8_t)i, BANKGRID_FAIL);
+            test_passed[CHECK_ADDR]++;
+        }
+    }
+    set_bank(0);
+}
+
+/*
+ * Test 9: March C-
+ * ================
+ *
+ * Run the March C- test over lower memory, upper memory and all banks. Each
+ * element visits every cell in ascending or descending address order, which
+ * exposes coupling faults between cells that a constant fill cannot detect.
+ */
+void ram_test_09(void) {
+    print_info("Test 9: March C-", 0);
+
+    test_passed[CHECK_MARCH] += march_run(march_c_minus, MARCH_C_MINUS_LEN,
+                                uppermembanks, highmembanks, highbank_selector);
 }
 
-void set_bank_highmem(uint8_t bank) {
-    z80_outp(0x95, bank);
+/*
+ * Test 10: Stripe sampling
+ * ========================
+ *
+ * Quick test of the FAST profile. Only a stripe of STRIPE_BYTES per 256-byte
+ * page is tested, where the stripe shifts through the page from one page to
+ * the next such that every address line still toggles. All banks are written
+ * before any bank is verified, which exposes banks that alias each other. The
+ * sweep is repeated with inverted values to check every data bit both ways.
+ */
+void ram_test_10(void) {
+    print_info("Test 10: Stripe sampling", 0);
+
+    for(uint8_t i=0; i<highmembanks; i++) {
+        set_bank(i == 0 ? 0 : highbank_selector);
+        uint16_t miscounts = 0;
+        for(uint8_t j=0; j<sizeof(stripe_inversions); j++) {
+            uint8_t val = fingerprint(i) ^ stripe_inversions[j];
+            stripe_fill(&memory[HIGHMEM_START], HIGHMEM_PAGES, val);
+            miscounts += stripe_count(&memory[HIGHMEM_START], HIGHMEM_PAGES, val, i);
+            timing_add_bytes(2 * HIGHMEM_PAGES * STRIPE_BYTES);
+        }
+        write_region_result(HIGHMEM_START, HIGHMEM_STOP, i, miscounts);
+        if(miscounts != 0) {
+            test_passed[CHECK_STRIPE]++;
+        }
+    }
+
+    print_info("  Sampling banks", 0);
+
+    for(uint8_t j=0; j<sizeof(stripe_inversions); j++) {
+        uint8_t invert = stripe_inversions[j];
+        for(uint16_t i=0; i<uppermembanks; i++) {
+            set_bank(i);
+            stripe_fill(&memory[BANKMEM_START], BANK_PAGES, tag_byte(0x00, (uint8_t)i) ^ invert);
+            timing_add_bytes(BANK_PAGES * STRIPE_BYTES);
+            bankgrid_set((uint8_t)i, BANKGRID_WRITTEN);
+        }
+
+        for(uint16_t i=0; i<uppermembanks; i++) {
+            set_bank(i);
+            uint16_t miscounts = stripe_count(&memory[BANKMEM_START], BANK_PAGES,
+                                              tag_byte(0x00, (uint8_t)i) ^ invert, (uint8_t)i);
+            timing_add_bytes(BANK_PAGES * STRIPE_BYTES);
+            if(miscounts == 0) {
+                bankgrid_set((uint8_t)i, BANKGRID_PASS);
+            } else {
+                bankgrid_set((uint8_t)i, BANKGRID_FAIL);
+                test_passed[CHECK_STRIPE]++;
+            }
+        }
+    }
+    set_bank(0);
+}
+
+/*
+ * Test 11: Random data
+ * ====================
+ *
+ * Write a pseudo-random stream to upper memory and to all banks and verify it
+ * by regenerating the stream from its seed. Every bank obtains its own seed,
+ * derived from the seed of the run. The seed of the run is taken from the
+ * tick counter and printed, such that a failing run can be replayed by
+ * defining LFSR_SEED (see config.h).
+ */
+void ram_test_11(void) {
+    print_info("Test 11: Random data", 0);
+
+#ifdef LFSR_SEED
+    uint16_t seed = LFSR_SEED;
+#else
+    uint16_t seed = get_ticks();
+#endif
+    terminal_beginline();
+    fmt_str("  Seed: 0x");
+    fmt_hex16(seed);
+    terminal_newline();
+    serial_begin('L');
+    serial_field_hex16(seed);
+    serial_end();
+
+    for(uint8_t i=0; i<highmembanks; i++) {
+        set_bank(i == 0 ? 0 : highbank_selector);
+        uint16_t s = lfsr_seed(~seed, i);     // differs from the seeds of the banks
+        fill_lfsr_pattern(&memory[HIGHMEM_START], s, HIGHMEM_PAGES);
+        uint16_t miscounts = count_lfsr_pattern(&memory[HIGHMEM_START], s, HIGHMEM_PAGES);
+        timing_add_bytes(2 * (HIGHMEM_STOP - HIGHMEM_START + 1));
+
+        write_region_result(HIGHMEM_START, HIGHMEM_STOP, i, miscounts);
+        if(miscounts != 0) {
+            write_seed_failure(0xFFFF, s, miscounts);
+            test_passed[CHECK_RANDOM]++;
+        }
+    }
+
+    print_info("  Writing data to banks", 0);
+
+    for(uint16_t i=0; i<uppermembanks; i++) {
+        set_bank(i);
+        fill_lfsr_pattern(&memory[BANKMEM_START], lfsr_seed(seed, (uint8_t)i), BANK_PAGES);
+        timing_add_bytes(BANK_BYTES);
+        bankgrid_set((uint8_t)i, BANKGRID_WRITTEN);
+    }
+
+    print_info("  Testing data on banks", 0);
+
+    for(uint16_t i=0; i<uppermembanks; i++) {
+        set_bank(i);
+        uint16_t s = lfsr_seed(seed, (uint8_t)i);
+        uint16_t miscounts = count_lfsr_pattern(&memory[BANKMEM_START], s, BANK_PAGES);
+        timing_add_bytes(BANK_BYTES);
+        if(miscounts == 0) {
+            bankgrid_set((uint8_t)i, BANKGRID_PASS);
+        } else {
+            bankgrid_set((uint8_t)i, BANKGRID_FAIL);
+            write_seed_failure(i, s, miscounts);
+            test_passed[CHECK_RANDOM]++;
+        }
+    }
+    set_bank(0);
+}
+
+/*
+ * Test 12: Copied data
+ * ====================
+ *
+ * Copy the cartridge, which holds arbitrary data (this program), to upper
+ * memory and an 8 KiB window of it to all banks, where the window shifts by
+ * COPY_STEP from one bank to the next. Every copy is verified by its CRC-16
+ * signature against the signature of its source, hence the banks are read
+ * only once. Only for a failing copy are the bytes that differ counted.
+ */
+void ram_test_12(void) {
+    print_info("Test 12: Copied data", 0);
+
+    uint16_t signatures[COPY_WINDOWS];
+    for(uint8_t j=0; j<COPY_WINDOWS; j++) {
+        signatures[j] = crc16_ram_pages(copy_window(j), CRC16_INIT, BANK_PAGES);
+    }
+    uint16_t cartridge = crc16_ram_pages(&memory[CARTRIDGE_START], CRC16_INIT, HIGHMEM_PAGES);
+
+    for(uint8_t i=0; i<highmembanks; i++) {
+        set_bank(i == 0 ? 0 : highbank_selector);
+        memcpy(&memory[HIGHMEM_START], &memory[CARTRIDGE_START], HIGHMEM_STOP - HIGHMEM_START + 1);
+        uint16_t miscounts = 0;
+        if(crc16_ram_pages(&memory[HIGHMEM_START], CRC16_INIT, HIGHMEM_PAGES) != cartridge) {
+            miscounts = count_copy_errors(&memory[HIGHMEM_START], &memory[CARTRIDGE_START],
+                                          HIGHMEM_STOP - HIGHMEM_START + 1);
+            test_passed[CHECK_COPY]++;
+        }
+        timing_add_bytes(2 * (HIGHMEM_STOP - HIGHMEM_START + 1));
+
+        write_region_result(HIGHMEM_START, HIGHMEM_STOP, i, miscounts);
+    }
+
+    print_info("  Writing data to banks", 0);
+
+    for(uint16_t i=0; i<uppermembanks; i++) {
+        set_bank(i);
+        memcpy(&memory[BANKMEM_START], copy_window((uint8_t)i), BANK_BYTES);
+        timing_add_bytes(BANK_BYTES);
+        bankgrid_set((uint8_t)i, BANKGRID_WRITTEN);
+    }
+
+    print_info("  Testing data on banks", 0);
+
+    for(uint16_t i=0; i<uppermembanks; i++) {
+        set_bank(i);
+        timing_add_bytes(BANK_BYTES);
+        if(crc16_ram_pages(&memory[BANKMEM_START], CRC16_INIT, BANK_PAGES) == signatures[i % COPY_WINDOWS]) {
+            bankgrid_set((uint8_t)i, BANKGRID_PASS);
+        } else {
+            bankgrid_set((uint8_t)i, BANKGRID_FAIL);
+            test_passed[CHECK_COPY]++;
+            uint16_t miscounts = count_copy_errors(&memory[BANKMEM_START], copy_window((uint8_t)i), BANK_BYTES);
+            write_region_result(BANKMEM_START, BANKMEM_STOP, (uint8_t)i, miscounts);
+        }
+    }
+    set_bank(0);
+}
+
+/*
+ * Test 13: Data bus
+ * =================
+ *
+ * Walk a single one and a single zero over the data lines of the bank
+ * register (port 0x94) and of the bank window (0xE000 in bank 0). This takes
+ * well below a millisecond and pinpoints a broken data line, which would
+ * otherwise show up as a failure of every bank in every test.
+ */
+void ram_test_13(void) {
+    print_info("Test 13: Data bus", 0);
+
+    uint8_t port = 0;
+    uint8_t mem = 0;
+
+    // only the lines that select one of the detected banks are walked; a
+    // board with a single bank has no lines to walk and a board without banks
+    // has neither a bank register nor RAM at 0xE000
+    if(uppermembanks >= 2) {
+        port = bus_walk_port(bank_register_mask());
+        write_bus_result("Port 0x94", port);
+    } else {
+        print_info("  Port 0x94: no bank register", 0);
+    }
+
+    if(uppermembanks != 0) {
+        set_bank(0);
+        mem = bus_walk_memory((volatile uint8_t*)&memory[BANKMEM_START]);
+        write_bus_result("0xE000   ", mem);
+    } else {
+        print_info("  0xE000: no banks", 0);
+    }
+
+    for(uint8_t i=0; i<8; i++) {
+        if((port | mem) & (1 << i)) {
+            test_passed[CHECK_BUS]++;
+        }
+    }
+}
+
+/*
+ * Test 14: Bank probe
+ * ===================
+ *
+ * Write a tag to the first byte of every bank and to the bytes at the offsets
+ * 1, 2, 4, ..., 0x1000, i.e. one byte per address line of the bank window.
+ * All banks are written before any bank is read back, such that a missing
+ * bank, a bank aliasing another bank and a stuck address line are found in a
+ * fraction of a second. Failing banks are marked in the bank grid.
+ */
+void ram_test_14(void) {
+    print_info("Test 14: Bank probe", 0);
+
+    for(uint16_t i=0; i<uppermembanks; i++) {
+        set_bank(i);
+        for(uint8_t k=0; k<PROBE_BYTES; k++) {
+            memory[BANKMEM_START + probe_offset(k)] = tag_byte(i, k);
+        }
+        timing_add_bytes(PROBE_BYTES);
+        bankgrid_set((uint8_t)i, BANKGRID_WRITTEN);
+    }
+
+    for(uint16_t i=0; i<uppermembanks; i++) {
+        set_bank(i);
+        uint16_t miscounts = 0;
+        for(uint8_t k=0; k<PROBE_BYTES; k++) {
+            miscounts += fault_count_ram_bytes(&memory[BANKMEM_START + probe_offset(k)],
+                                               tag_byte(i, k), 1, (uint8_t)i);
+        }
+        timing_add_bytes(PROBE_BYTES);
+        if(miscounts == 0) {
+            bankgrid_set((uint8_t)i, BANKGRID_PASS);
+        } else {
+            bankgrid_set((uint8_t)i, BANKGRID_FAIL);
+            test_passed[CHECK_PROBE]++;
+        }
+    }
+    set_bank(0);
+}
+
+/*
+ * Test 15: Failing banks
+ * ======================
+ *
+ * Run the checkerboard and stuck-at patterns over every byte of the banks
+ * that failed a previous test, recording the failing bytes in the fault map
+ * to identify the failing bits and chips. This test is only scheduled when
+ * the probe tests fail (see registry.h).
+ */
+void ram_test_15(void) {
+    print_info("Test 15: Failing banks", 0);
+
+    for(uint16_t i=0; i<uppermembanks; i++) {
+        if(bankgrid_get((uint8_t)i) != BANKGRID_FAIL) {
+            continue;
+        }
+        set_bank(i);
+        uint16_t miscounts = test_region_patterns(&memory[BANKMEM_START], BANK_BYTES, (uint8_t)i);
+        write_region_result(BANKMEM_START, BANKMEM_STOP, (uint8_t)i, miscounts);
+        if(miscounts != 0) {
+            test_passed[CHECK_DIAG]++;
+        }
+    }
+    set_bank(0);
 }
 
 /**
@@ -372,8 +819,6 @@ uint8_t read_bank(void) {
 uint8_t test_bank_helper(uint8_t startbank, uint8_t stopbank, uint8_t *uppermembanks,
                         uint8_t *expansion_type, uint8_t banktypefail, uint16_t szdetect) {
     
-    char buf[50];
-
     // write test bit to new banks to be probed
     for(uint8_t i=startbank; i<stopbank; i++) {
         set_bank(i);
@@ -395,83 +840,317 @@ uint8_t test_bank_helper(uint8_t startbank, uint8_t stopbank, uint8_t *uppermemb
     // analyse results
     if((*uppermembanks) != stopbank) {
         (*expansion_type) = banktypefail;
-        sprintf(buf, "%u KiB expansion card detected", szdetect);
-        print_inline_color(buf, COL_GREEN);
+        terminal_beginline();
+        fmt_str("  ");
+        fmt_char(COL_GREEN);
+        fmt_dec(szdetect, 0);
+        fmt_str(" KiB expansion card detected");
+        terminal_newline();
         return 1;
     } else {
-        sprintf(termbuffer, "  Banks %u - %u probed", startbank, stopbank-1);
-        terminal_printtermbuffer();
+        terminal_beginline();
+        fmt_str("  Banks ");
+        fmt_dec(startbank, 0);
+        fmt_str(" - ");
+        fmt_dec(stopbank-1, 0);
+        fmt_str(" probed");
+        terminal_newline();
         return 0;
     }
 }
 
 /**
- * Apply a fixed byte pattern to a set of RAM banks and verify whether these can be
- * read back.
+ * Write the 0x55/0xAA/0x00/0xFF sequence to a memory region, where every
+ * pattern is verified in the same sweep that writes the next pattern. Failing
+ * bytes of the final pattern are recorded in the fault log under bank.
+ */
+uint16_t test_region_patterns(char *region, uint16_t nrbytes, uint8_t bank) {
+    fill_ram_bytes(region, test_patterns[0], nrbytes);
+    timing_add_bytes(nrbytes);
+    uint16_t miscounts = 0;
+    for(uint8_t i=1; i<sizeof(test_patterns); i++) {
+        miscounts += fill_verify_ram_bytes(region, test_patterns[i-1], test_patterns[i], nrbytes);
+        timing_add_bytes(nrbytes);
+    }
+    miscounts += fault_count_ram_bytes(region, test_patterns[sizeof(test_patterns)-1], nrbytes, bank);
+    timing_add_bytes(nrbytes);
+
+    return miscounts;
+}
+
+/**
+ * Write a byte to a stripe of STRIPE_BYTES in every 256-byte page of a
+ * region; the stripe advances by STRIPE_BYTES from one page to the next.
  */
-void test_fixed_pattern(uint8_t pattern, uint8_t check_id) {
-    sprintf(termbuffer, "  Writing 0x%02X to banks", pattern);
-    terminal_printtermbuffer();
-    uint8_t miscounts = 0;
+void stripe_fill(char *region, uint8_t nrpages, uint8_t val) {
+    uint8_t offset = 0;
+    for(uint8_t i=0; i<nrpages; i++) {
+        fill_ram_bytes(region + offset, val, STRIPE_BYTES);
+        region += 0x100;
+        offset += STRIPE_BYTES;
+    }
+}
+
+/**
+ * Count the bytes in the stripes written by stripe_fill that differ from a
+ * check byte, recording failing bytes in the fault log under bank.
+ */
+uint16_t stripe_count(char *region, uint8_t nrpages, uint8_t val, uint8_t bank) {
+    uint16_t miscounts = 0;
+    uint8_t offset = 0;
+    for(uint8_t i=0; i<nrpages; i++) {
+        miscounts += fault_count_ram_bytes(region + offset, val, STRIPE_BYTES, bank);
+        region += 0x100;
+        offset += STRIPE_BYTES;
+    }
+    return miscounts;
+}
+
+/**
+ * Verify the tags written by test 5 or the bank pipeline in a read-only sweep
+ * over all RAM banks.
+ */
+void test_tag_sweep(void) {
+    print_info("  Testing data on banks", 0);
 
     for(uint16_t i=0; i<uppermembanks; i++) {
         set_bank(i);
-        memset(&memory[BANKMEM_START], pattern, BANKMEM_STOP - BANKMEM_START + 1);
-        write_termbuffer_value((uint8_t)i, COL_CYAN);
-
-        if((i+1) % 8 == 0) {
-            terminal_printtermbuffer();
+        uint8_t t = tag_byte(0x00, (uint8_t)i);
+        uint16_t miscounts = fault_count_ram_bytes(&memory[BANKMEM_START], t, BANK_BYTES, (uint8_t)i);
+        timing_add_bytes(BANK_BYTES);
+        if(miscounts == 0) {
+            bankgrid_set((uint8_t)i, BANKGRID_PASS);
+        } else {
+            bankgrid_set((uint8_t)i, BANKGRID_FAIL);
+            test_passed[CHECK_TAGS]++;
         }
     }
+}
 
-    // also print result when total is not divisible by 8
-    if(uppermembanks % 8 != 0) {
-        terminal_printtermbuffer();
+/**
+ * Perform a single sweep over all RAM banks. Depending on the mode, each bank
+ * is verified against the pattern written in the previous sweep, overwritten
+ * with a new pattern, or both during a single visit of the bank.
+ */
+void test_pattern_sweep(uint8_t verify, uint8_t fill, uint8_t check_id, uint8_t mode) {
+    terminal_beginline();
+    if(mode == SWEEP_WRITE) {
+        fmt_str("  Writing 0x");
+        fmt_hex8(fill);
+        fmt_str(" to banks");
+    } else if(mode == SWEEP_VERIFY) {
+        fmt_str("  Testing 0x");
+        fmt_hex8(verify);
+        fmt_str(" on banks");
+    } else {
+        fmt_str("  Testing 0x");
+        fmt_hex8(verify);
+        fmt_str(", writing 0x");
+        fmt_hex8(fill);
     }
-
-    sprintf(termbuffer, "  Testing 0x%02X on banks", pattern);
-    terminal_printtermbuffer();
+    terminal_newline();
 
     for(uint16_t i=0; i<uppermembanks; i++) {
         set_bank(i);
-        uint16_t miscounts_bank = count_ram_bytes(&memory[BANKMEM_START], pattern, BANKMEM_STOP - BANKMEM_START + 1);
-        if(miscounts_bank == 0) {
-            write_termbuffer_value((uint8_t)i, COL_GREEN);
+
+        // the push-based bank fill is faster than the fused kernel, hence
+        // verify and write are performed as two passes on the same bank
+        if(mode & SWEEP_VERIFY) {
+            uint16_t miscounts_bank = fault_count_ram_bytes(&memory[BANKMEM_START], verify, BANK_BYTES, (uint8_t)i);
+            timing_add_bytes(BANK_BYTES);
+            if(miscounts_bank == 0) {
+                bankgrid_set((uint8_t)i, BANKGRID_PASS);
+            } else {
+                bankgrid_set((uint8_t)i, BANKGRID_FAIL);
+                test_passed[check_id]++;
+            }
         } else {
-            write_termbuffer_value((uint8_t)i, COL_RED);
-            test_passed[check_id]++;
+            bankgrid_set((uint8_t)i, BANKGRID_WRITTEN);
+        }
+
+        if(mode & SWEEP_WRITE) {
+            fill_bank_window(PATTERN16(fill));
+            timing_add_bytes(BANK_BYTES);
         }
+    }
+}
+
+/**
+ * Helper function to print the result of a pattern test on a memory region,
+ * e.g. "  0xA000 - 0xDFFF (0): OK"; the bank number is omitted when 0xFF.
+ */
+void write_region_result(uint16_t start, uint16_t stop, uint8_t bank, uint16_t miscounts) {
+    terminal_beginline();
+    fmt_str("  0x");
+    fmt_hex16(start);
+    fmt_str(" - 0x");
+    fmt_hex16(stop);
+    if(bank != 0xFF) {
+        fmt_str(" (");
+        fmt_dec(bank, 0);
+        fmt_char(')');
+    }
+    fmt_str(": ");
+    if(miscounts == 0) {
+        fmt_char(COL_GREEN);
+        fmt_str("OK");
+    } else {
+        fmt_char(COL_RED);
+        fmt_dec(miscounts, 0);
+        fmt_str(" miscounts");
+    }
+    terminal_newline();
+}
+
+/**
+ * Print the seed with which a bank failed test 11; a bank of 0xFFFF denotes
+ * the high memory bank printed on the line above.
+ */
+void write_seed_failure(uint16_t bank, uint16_t seed, uint16_t miscounts) {
+    terminal_beginline();
+    fmt_str("  ");
+    if(bank != 0xFFFF) {
+        fmt_str("BANK ");
+        fmt_dec(bank, 0);
+        fmt_char(' ');
+    }
+    fmt_str("SEED 0x");
+    fmt_hex16(seed);
+    fmt_str(": ");
+    fmt_char(COL_RED);
+    fmt_dec(miscounts, 0);
+    fmt_str(" miscounts");
+    terminal_newline();
+}
 
-        if((i+1) % 8 == 0) {
-            terminal_printtermbuffer();
+/**
+ * Return the data lines of the bank register that select one of the detected
+ * banks; the other lines need not be latched and may float when read back.
+ */
+uint8_t bank_register_mask(void) {
+    uint8_t mask = 0;
+    while(mask < uppermembanks - 1 && mask != 0xFF) {
+        mask = (mask << 1) | 0x01;
+    }
+    if(highbank_selector == HIGHBANK_1056) {
+        mask |= 0x80;
+    }
+    return mask;
+}
+
+/**
+ * Walk a single one and a single zero over the data lines in mask of the bank
+ * register and return the lines that were not read back; the bank register
+ * is left in an arbitrary state.
+ */
+uint8_t bus_walk_port(uint8_t mask) {
+    uint8_t failed = 0;
+    for(uint8_t i=0; i<8; i++) {
+        uint8_t bit = 1 << i;
+        if(!(mask & bit)) {
+            continue;
         }
+        z80_outp(0x94, bit);
+        failed |= (read_bank() ^ bit) & mask;
+        z80_outp(0x94, ~bit & mask);
+        failed |= (read_bank() ^ (~bit & mask)) & mask;
     }
+    return failed;
+}
 
-    // also print result when total is not divisible by 8
-    if(uppermembanks % 8 != 0) {
-        terminal_printtermbuffer();
+/**
+ * Walk a single one and a single zero over the data lines of a byte in
+ * memory and return the lines that were not read back. The neighbouring byte
+ * receives the inverse before the byte is read back, such that a floating
+ * data line cannot return the value that was just written.
+ */
+uint8_t bus_walk_memory(volatile uint8_t *p) {
+    uint8_t failed = 0;
+    for(uint8_t i=0; i<8; i++) {
+        uint8_t bit = 1 << i;
+        p[0] = bit;
+        p[1] = ~bit;
+        failed |= p[0] ^ bit;
+        p[0] = ~bit;
+        p[1] = bit;
+        failed |= p[0] ^ (uint8_t)~bit;
     }
+    return failed;
 }
 
-static inline char hex1(uint8_t v) {
-    static const char hexd[] = "0123456789ABCDEF";  // size = 17 (includes '\0')
-    return hexd[v & 0xF];
+/**
+ * Print the data lines D7-D0 of a bus, marking failing lines with an X
+ */
+void write_bus_result(const char *name, uint8_t failed) {
+    terminal_beginline();
+    fmt_str("  ");
+    fmt_str(name);
+    fmt_str(" D7-D0: ");
+    if(failed == 0) {
+        fmt_color(COL_GREEN, "OK");
+    } else {
+        fmt_char(COL_RED);
+        for(uint8_t i=8; i-- > 0; ) {
+            fmt_char((failed & (1 << i)) ? 'X' : '.');
+        }
+    }
+    terminal_newline();
+}
+
+/**
+ * Count the bytes of a copy that differ from its source; only used to report
+ * a copy of which the signature does not match.
+ */
+uint16_t count_copy_errors(const char *copy, const char *source, uint16_t nrbytes) {
+    uint16_t miscounts = 0;
+    for(uint16_t i=0; i<nrbytes; i++) {
+        if(copy[i] != source[i]) {
+            miscounts++;
+        }
+    }
+    return miscounts;
 }
 
 /**
- * Helper function to write 4-byte colored hex value to string buffer;
- * used to indicate RAM banks.
+ * Export the summary, the state of every bank and the fault map over the
+ * serial line (see serial.h) and wait until all records have been sent.
  */
-void write_termbuffer_value(uint8_t i, uint8_t color) {
-    // 4 visible chars + NUL; we intentionally copy 5 bytes into a 4-byte slot
-    // so the NUL becomes the first byte of the next cell.
-    char tmp[5];
-    tmp[0] = (char)color;
-    tmp[1] = hex1((uint8_t)(i >> 4));
-    tmp[2] = hex1((uint8_t)i);
-    tmp[3] = (char)COL_WHITE;
-    tmp[4] = '\0';
-    memcpy(&termbuffer[(i % 8) * 4], tmp, 5);
+void export_results(void) {
+    uint8_t failed = 0;
+    for(uint8_t i=0; i<NR_CHECKS; i++) {
+        if(!(checks_run & CHECK_BIT(i))) {
+            continue;
+        }
+        serial_begin('R');
+        serial_field_dec(i+1);
+        serial_field_dec(test_passed[i]);
+        serial_end();
+        if(test_passed[i] != 0) {
+            failed++;
+        }
+    }
+
+    // one record per line of the bank grid
+    char states[BANKGRID_COLS + 1];
+    for(uint16_t i=0; i<uppermembanks; i+=BANKGRID_COLS) {
+        uint8_t n = 0;
+        for(uint16_t j=i; j<i+BANKGRID_COLS && j<uppermembanks; j++) {
+            uint8_t state = bankgrid_get((uint8_t)j);
+            states[n++] = (state == BANKGRID_PASS) ? 'P' : ((state == BANKGRID_FAIL) ? 'F' : '-');
+        }
+        states[n] = 0;
+        serial_begin('G');
+        serial_field_hex8((uint8_t)i);
+        serial_field_str(states);
+        serial_end();
+    }
+
+    fault_export();
+
+    serial_begin('E');
+    serial_field_dec(failed);
+    serial_end();
+    serial_flush();
 }
 
 /**
@@ -482,13 +1161,23 @@ void init(void) {
     terminal_init(3, 20);
     vidmem[0x50] = TEXT_DOUBLE;
     vidmem[0x50+1] = COL_CYAN;
-    sprintf(&vidmem[0x50+2], "RAM TESTER");
+    fmt_at(&vidmem[0x50+2]);
+    fmt_str("RAM TESTER");
 
     // insert cursor
-    sprintf(termbuffer, "%c>%c", COL_CYAN, COL_WHITE);
-    terminal_redoline();
+    terminal_beginline();
+    fmt_color(COL_CYAN, ">");
     
-    set_bank(0);    // always set bank 0 upon initializati`on
-    sprintf(&vidmem[0x50*22], "Version: %s", __VERSION__);
-    sprintf(&vidmem[0x50*23], "Compiled at: %s / %s", __DATE__, __TIME__);
+    bank_select(0);    // always set bank 0 upon initialization
+    bank_status_render();
+    fmt_at(&vidmem[0x50*22]);
+    fmt_str("Version: ");
+    fmt_str(__VERSION__);
+    fmt_at(&vidmem[0x50*23]);
+    fmt_str("Compiled at: ");
+    fmt_str(__DATE__);
+    fmt_str(" / ");
+    fmt_str(__TIME__);
+
+    serial_init();
 }
@@ -0,0 +1,185 @@
+/**************************************************************************
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   P2000T-RAMTESTER is free software:                                   *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   P2000T-RAMTESTER software is distributed in the hope that it will    *
+ *   be useful, but WITHOUT ANY WARRANTY; without even the implied        *
+ *   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#include "march.h"
+
+/*
+ * March C-: {any(w0); up(r0,w1); up(r1,w0); down(r0,w1); down(r1,w0); any(r0)}
+ */
+const march_element_t march_c_minus[MARCH_C_MINUS_LEN] = {
+    {MARCH_UP | MARCH_WRITE,                0x00, 0x00},
+    {MARCH_UP | MARCH_READ | MARCH_WRITE,   0x00, 0xFF},
+    {MARCH_UP | MARCH_READ | MARCH_WRITE,   0xFF, 0x00},
+    {MARCH_DOWN | MARCH_READ | MARCH_WRITE, 0x00, 0xFF},
+    {MARCH_DOWN | MARCH_READ | MARCH_WRITE, 0xFF, 0x00},
+    {MARCH_UP | MARCH_READ,                 0x00, 0x00},
+};
+
+static uint16_t _nrbanks = 0;
+static uint8_t _nrhighbanks = 0;
+static bankaddr_t _highbank_selector = 0;
+
+/**
+ * Select region r of the address space and return a pointer to its start;
+ * region 0 is lower memory, followed by the high memory banks and the 8 KiB
+ * banks.
+ */
+static char* march_region(uint16_t r, uint16_t *nrbytes) {
+    if(r == 0) {
+        *nrbytes = STACK - LOWMEM;
+        return &memory[LOWMEM];
+    }
+    r--;
+
+    if(r < _nrhighbanks) {
+        set_bank(r == 0 ? 0 : _highbank_selector);
+        *nrbytes = HIGHMEM_STOP - HIGHMEM_START + 1;
+        return &memory[HIGHMEM_START];
+    }
+    r -= _nrhighbanks;
+
+    set_bank(r);
+    *nrbytes = BANK_BYTES;
+    return &memory[BANKMEM_START];
+}
+
+/**
+ * Return the bank of region r as stored in fault records
+ */
+static uint8_t march_bank(uint16_t r) {
+    if(r == 0) {
+        return 0;
+    }
+    r--;
+    return (uint8_t)((r < _nrhighbanks) ? r : r - _nrhighbanks);
+}
+
+/**
+ * Write a short description of a march element, e.g. "up(r00,wFF)"
+ */
+static void march_describe(const march_element_t *e) {
+    fmt_str((e->flags & MARCH_DOWN) ? "dn(" : "up(");
+    if(e->flags & MARCH_READ) {
+        fmt_char('r');
+        fmt_hex8(e->verify);
+    }
+    if((e->flags & (MARCH_READ | MARCH_WRITE)) == (MARCH_READ | MARCH_WRITE)) {
+        fmt_char(',');
+    }
+    if(e->flags & MARCH_WRITE) {
+        fmt_char('w');
+        fmt_hex8(e->fill);
+    }
+    fmt_char(')');
+}
+
+/**
+ * @brief Apply a single march element to all memory regions
+ *
+ * @param e march element
+ * @return uint16_t number of miscounts (saturated)
+ */
+uint16_t march_element(const march_element_t *e) {
+    uint16_t nrregions = 1 + _nrhighbanks + _nrbanks;
+    uint16_t miscounts = 0;
+
+    for(uint16_t i=0; i<nrregions; i++) {
+        uint16_t r = (e->flags & MARCH_DOWN) ? nrregions - 1 - i : i;
+        uint16_t nrbytes;
+        char *mem = march_region(r, &nrbytes);
+        uint16_t m = 0;
+
+        if(e->flags & MARCH_READ) {
+            if(!(e->flags & MARCH_WRITE)) {
+                m = fault_count_ram_bytes(mem, e->verify, nrbytes, march_bank(r));
+            } else if(e->flags & MARCH_DOWN) {
+                m = fill_verify_ram_bytes_desc(mem, e->verify, e->fill, nrbytes);
+            } else {
+                m = fill_verify_ram_bytes(mem, e->verify, e->fill, nrbytes);
+            }
+        } else if(mem == &memory[BANKMEM_START]) {
+            // address order is irrelevant for a write-only element
+            fill_bank_window(PATTERN16(e->fill));
+        } else {
+            fill_ram_bytes(mem, e->fill, nrbytes);
+        }
+
+        timing_add_bytes(nrbytes);
+        miscounts = (miscounts + m < miscounts) ? 0xFFFF : miscounts + m;
+    }
+
+    set_bank(0);
+    return miscounts;
+}
+
+/**
+ * @brief Run a march test over lower memory, all high memory banks and all
+ *        8 KiB banks, reporting the elapsed time per element
+ *
+ * @param elements          table of march elements
+ * @param nrelements        number of elements
+ * @param nrbanks           number of 8 KiB banks
+ * @param nrhighbanks       number of 16 KiB high memory banks
+ * @param highbank_selector selector of the second high memory bank
+ * @return uint8_t number of elements that encountered errors
+ */
+uint8_t march_run(const march_element_t *elements, uint8_t nrelements,
+                  uint16_t nrbanks, uint8_t nrhighbanks, bankaddr_t highbank_selector) {
+    uint8_t failed = 0;
+
+    _nrbanks = nrbanks;
+    _nrhighbanks = nrhighbanks;
+    _highbank_selector = highbank_selector;
+
+    for(uint8_t i=0; i<nrelements; i++) {
+        uint16_t start = get_ticks();
+        uint16_t miscounts = march_element(&elements[i]);
+        uint16_t elapsed = get_ticks() - start;
+
+        uint16_t ticks_per_second = 1000 / TIMER_INTERVAL;
+        uint16_t hundredths = (elapsed % ticks_per_second) * (100 / ticks_per_second);
+
+        terminal_beginline();
+        fmt_str("  M");
+        fmt_dec(i, 0);
+        fmt_char(' ');
+        char *desc = fmt_ptr;
+        march_describe(&elements[i]);
+        fmt_pad(desc, 11);
+        fmt_char(' ');
+        fmt_dec(elapsed / ticks_per_second, 3);
+        fmt_char('.');
+        fmt_dec2(hundredths);
+        fmt_char('s');
+        fmt_char(' ');
+        if(miscounts == 0) {
+            fmt_char(COL_GREEN);
+            fmt_str("OK");
+        } else {
+            fmt_char(COL_RED);
+            fmt_dec(miscounts, 0);
+            fmt_str(" errors");
+            failed++;
+        }
+        terminal_newline();
+    }
+
+    return failed;
+}
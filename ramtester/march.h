@@ -0,0 +1,77 @@
+/**************************************************************************
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   P2000T-RAMTESTER is free software:                                   *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   P2000T-RAMTESTER software is distributed in the hope that it will    *
+ *   be useful, but WITHOUT ANY WARRANTY; without even the implied        *
+ *   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#ifndef _MARCH_H
+#define _MARCH_H
+
+#include <stdint.h>
+
+#include "constants.h"
+#include "memory.h"
+#include "terminal.h"
+#include "util.h"
+#include "ramtest.h"
+#include "fill.h"
+#include "bankcounting.h"
+#include "timing.h"
+#include "faultmap.h"
+
+#define MARCH_UP        0x00    // ascending address order
+#define MARCH_DOWN      0x01    // descending address order
+#define MARCH_READ      0x02    // read and verify every cell
+#define MARCH_WRITE     0x04    // write every cell
+
+/*
+ * Single element of a march test; every cell is (optionally) verified
+ * against the verify byte after which the fill byte is (optionally) written.
+ */
+typedef struct {
+    uint8_t flags;
+    uint8_t verify;
+    uint8_t fill;
+} march_element_t;
+
+#define MARCH_C_MINUS_LEN   6
+
+extern const march_element_t march_c_minus[MARCH_C_MINUS_LEN];
+
+/**
+ * @brief Run a march test over lower memory, all high memory banks and all
+ *        8 KiB banks, reporting the elapsed time per element
+ *
+ * @param elements          table of march elements
+ * @param nrelements        number of elements
+ * @param nrbanks           number of 8 KiB banks
+ * @param nrhighbanks       number of 16 KiB high memory banks
+ * @param highbank_selector selector of the second high memory bank
+ * @return uint8_t number of elements that encountered errors
+ */
+uint8_t march_run(const march_element_t *elements, uint8_t nrelements,
+                  uint16_t nrbanks, uint8_t nrhighbanks, bankaddr_t highbank_selector);
+
+/**
+ * @brief Apply a single march element to all memory regions
+ *
+ * @param e march element
+ * @return uint16_t number of miscounts (saturated)
+ */
+uint16_t march_element(const march_element_t *e);
+
+#endif // _MARCH_H
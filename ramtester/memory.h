@@ -21,13 +21,17 @@
 #ifndef _MEMORY_H
 #define _MEMORY_H
 
+#define CARTRIDGE_START 0x1000 // start address of the cartridge in SLOT1
 #define LOWMEM          0x7000 // starting point of lower memory
 #define HIGHMEM_START   0xA000 // start address of upper memory
 #define HIGHMEM_STOP    0xDFFF // end address of upper memory
 #define BANKMEM_START   0xE000 // starting point of bankable memory
 #define BANKMEM_STOP    0xFFFF // starting point of bankable memory
 #define BANK_BYTES      0x2000 // number of bytes per bank
+#define BANK_PAGES      0x20   // number of 256-byte pages per bank
+#define HIGHMEM_PAGES   0x40   // number of 256-byte pages in upper memory
 #define STACK           0x9F00 // lower position of the stack
+#define ISR_TABLE       0x6E00 // interrupt vector table, see interrupt.asm
 #define NUMBANKS        6
 
 extern char* memory;
@@ -0,0 +1,83 @@
+/**************************************************************************
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   P2000T-RAMTESTER is free software:                                   *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   P2000T-RAMTESTER software is distributed in the hope that it will    *
+ *   be useful, but WITHOUT ANY WARRANTY; without even the implied        *
+ *   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#include "profile.h"
+
+#define PROFILE_TESTS_BASE  (TEST_BIT(3) | TEST_BIT(13) | TEST_BIT(14))
+
+const profile_t profiles[NR_PROFILES] = {
+    {"FAST",       KEY_1, PROFILE_TESTS_BASE | TEST_BIT(10), FALSE},
+    {"STANDARD",   KEY_2, PROFILE_TESTS_BASE | TEST_BIT(4) | TEST_BIT(5) | TEST_BIT(6) |
+                          TEST_BIT(7), FALSE},
+    {"EXHAUSTIVE", KEY_3, PROFILE_TESTS_BASE | TEST_BIT(4) | TEST_BIT(5) | TEST_BIT(6) |
+                          TEST_BIT(7) | TEST_BIT(8) | TEST_BIT(9) | TEST_BIT(11) |
+                          TEST_BIT(12), TRUE},
+    {"PIPELINE",   KEY_4, PROFILE_TESTS_BASE | TEST_BIT(4) | TEST_BIT(16), FALSE},
+};
+
+/**
+ * Write a projected runtime in seconds as " mm:ss" at the format cursor
+ */
+static void profile_write_runtime(const profile_t *p, uint16_t nrbanks, uint8_t nrhighbanks) {
+    uint32_t kt = registry_cost(p->tests, nrbanks, nrhighbanks);
+    uint16_t secs = (uint16_t)(kt / CPU_KHZ);
+    uint8_t mins = 0;
+    while(secs >= 60) {
+        secs -= 60;
+        mins++;
+    }
+    fmt_char(' ');
+    fmt_dec(mins, 3);
+    fmt_char(':');
+    fmt_dec2((uint8_t)secs);
+}
+
+uint8_t profile_select(uint16_t nrbanks, uint8_t nrhighbanks) {
+    for(uint8_t i=0; i<NR_PROFILES; i++) {
+        terminal_beginline();
+        fmt_str("  ");
+        fmt_char(COL_YELLOW);
+        fmt_char('1' + i);
+        fmt_char(COL_WHITE);
+        char* start = fmt_ptr;
+        fmt_str(profiles[i].name);
+        fmt_pad(start, 10);
+        profile_write_runtime(&profiles[i], nrbanks, nrhighbanks);
+        terminal_newline();
+    }
+    print_info("  Select profile, STANDARD in 10 s", 0);
+
+    // unknown keys select STANDARD as well
+    uint8_t profile = PROFILE_STANDARD;
+    if(wait_for_key_ticks(PROFILE_TIMEOUT)) {
+        for(uint8_t i=0; i<NR_PROFILES; i++) {
+            if(keymem[0x00] == profiles[i].key) {
+                profile = i;
+            }
+        }
+    }
+
+    terminal_beginline();
+    fmt_str("  Profile: ");
+    fmt_color(COL_CYAN, profiles[profile].name);
+    terminal_newline();
+
+    return profile;
+}
@@ -0,0 +1,79 @@
+/**************************************************************************
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   P2000T-RAMTESTER is free software:                                   *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   P2000T-RAMTESTER software is distributed in the hope that it will    *
+ *   be useful, but WITHOUT ANY WARRANTY; without even the implied        *
+ *   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#ifndef _PROFILE_H
+#define _PROFILE_H
+
+#include <stdint.h>
+
+#include "constants.h"
+#include "memory.h"
+#include "terminal.h"
+#include "format.h"
+#include "timing.h"
+#include "util.h"
+#include "registry.h"
+
+/*
+ * A profile determines which tests run after the board has been detected,
+ * next to the data bus and bank probe tests (13 and 14) that run first:
+ *
+ *   FAST        bank register and a stripe sample of every page (test 10)
+ *   STANDARD    tests 3-7
+ *   EXHAUSTIVE  tests 3-9, 11 and 12, adding the address-in-address, March,
+ *               random data and copied data tests
+ *   PIPELINE    STANDARD with the bank pipeline (test 16) in place of tests
+ *               5-7, running their patterns while selecting every bank only
+ *               once instead of in eight sweeps
+ *
+ * All profiles but EXHAUSTIVE stop at the first failing tier of tests,
+ * EXHAUSTIVE runs all of its tests (see registry.h). The projected runtime is the sum of the
+ * costs of the tests in the registry.
+ */
+
+#define PROFILE_FAST        0
+#define PROFILE_STANDARD    1
+#define PROFILE_EXHAUSTIVE  2
+#define PROFILE_PIPELINE    3
+#define NR_PROFILES         4
+
+#define PROFILE_TIMEOUT     (10 * TICKS_PER_SECOND)  // select STANDARD when no key is pressed
+#define CPU_KHZ             2500
+
+typedef struct {
+    const char* name;
+    uint8_t key;            // key code, see constants.h
+    uint32_t tests;         // bitmask of test numbers, see TEST_BIT
+    uint8_t full;           // also run the tests following a failing tier
+} profile_t;
+
+extern const profile_t profiles[NR_PROFILES];
+
+/**
+ * @brief Show the profiles with their projected runtime and let the user
+ *        pick one; STANDARD is selected after PROFILE_TIMEOUT ticks
+ *
+ * @param nrbanks     number of 8 KiB banks
+ * @param nrhighbanks number of 16 KiB high memory banks
+ * @return uint8_t selected profile
+ */
+uint8_t profile_select(uint16_t nrbanks, uint8_t nrhighbanks);
+
+#endif // _PROFILE_H
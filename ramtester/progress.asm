@@ -0,0 +1,74 @@
+;-------------------------------------------------------------------------------
+;
+;   Author: Ivo Filot <ivo@ivofilot.nl>
+;
+;   P2000T-RAMTESTER is free software:
+;   you can redistribute it and/or modify it under the terms of the
+;   GNU General Public License as published by the Free Software
+;   Foundation, either version 3 of the License, or (at your option)
+;   any later version.
+;
+;   P2000T-RAMTESTER software is distributed in the hope that it will
+;   be useful, but WITHOUT ANY WARRANTY; without even the implied
+;   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+;   See the GNU General Public License for more details.
+;
+;   You should have received a copy of the GNU General Public License
+;   along with this program.  If not, see http://www.gnu.org/licenses/.
+;
+;-------------------------------------------------------------------------------
+
+SECTION code_user
+
+PUBLIC _progress_isr
+
+EXTERN _progress_active
+EXTERN _progress_render
+
+defc PROGRESS_INTERVAL = 25     ; must match progress.h
+
+;-------------------------------------------------------------------------------
+; Interrupt hook that redraws the status line once every PROGRESS_INTERVAL
+; ticks while a test runs. Ticks in between cost ~50 T-states.
+;
+; The status line is drawn by progress_render, compiled C, which may use IX,
+; IY and the alternate register set (32-bit arithmetic); these are saved
+; around the call. Drawing takes a few ms, well within a single tick.
+;
+; Garbles: af, bc, de, hl
+;-------------------------------------------------------------------------------
+_progress_isr:
+    ld a,(_progress_active)
+    or a
+    ret z                       ; no test running
+    ld hl,progress_countdown
+    dec (hl)
+    ret nz
+    ld (hl),PROGRESS_INTERVAL
+    push ix
+    push iy
+    ex af,af'
+    push af
+    ex af,af'
+    exx
+    push bc
+    push de
+    push hl
+    exx
+    call _progress_render
+    exx
+    pop hl
+    pop de
+    pop bc
+    exx
+    ex af,af'
+    pop af
+    ex af,af'
+    pop iy
+    pop ix
+    ret
+
+SECTION data_user
+
+progress_countdown:
+    defb PROGRESS_INTERVAL
@@ -0,0 +1,92 @@
+/**************************************************************************
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   P2000T-RAMTESTER is free software:                                   *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   P2000T-RAMTESTER software is distributed in the hope that it will    *
+ *   be useful, but WITHOUT ANY WARRANTY; without even the implied        *
+ *   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#include "progress.h"
+#include "bankcounting.h"
+
+volatile uint16_t progress_done = 0;
+volatile uint8_t progress_active = 0;      // read by progress.asm
+
+static uint8_t _progress_test = 0;
+static uint16_t _progress_total = 0;
+static uint16_t _progress_start = 0;
+
+void progress_begin(uint8_t test, uint16_t total) {
+    progress_active = 0;
+    _progress_test = test;
+    _progress_total = total;
+    _progress_start = get_ticks();
+    progress_done = 0;
+    progress_render();
+    progress_active = 1;
+}
+
+void progress_end(void) {
+    progress_active = 0;
+    progress_done = _progress_total;
+    progress_render();
+}
+
+/*
+ * The status line may be drawn while the interrupted code composes a line of
+ * text, hence the format cursor is restored on exit. Layout:
+ *
+ *   T 5 [16 cells] B 123 ETA mm:ss
+ */
+void progress_render(void) {
+    char* cursor = fmt_ptr;
+    uint16_t done = progress_done;
+    uint16_t total = _progress_total;
+    if(done > total) {
+        done = total;
+    }
+
+    vidmem[0x00] = COL_CYAN;
+    fmt_at(&vidmem[1]);
+    fmt_char('T');
+    fmt_dec(_progress_test, 2);
+    fmt_char(' ');
+    fmt_char(COL_GREEN);
+    uint8_t cells = total == 0 ? 0 : (uint8_t)(((uint32_t)done * PROGRESS_CELLS) / total);
+    for(uint8_t i=0; i<PROGRESS_CELLS; i++) {
+        fmt_char(i < cells ? GRAPH_BLOCK : '.');
+    }
+    fmt_char(COL_WHITE);
+    fmt_char('B');
+    fmt_dec((uint8_t)current_bank, 3);
+    fmt_str(" ETA ");
+    if(done == 0 || total == 0) {
+        fmt_str("--:--");
+    } else {
+        uint16_t elapsed = get_ticks() - _progress_start;
+        uint16_t secs = (uint16_t)(((uint32_t)elapsed * (total - done)) / ((uint32_t)done * TICKS_PER_SECOND));
+        uint8_t mins = 0;
+        while(secs >= 60 && mins < 99) {
+            secs -= 60;
+            mins++;
+        }
+        fmt_dec2(mins);
+        fmt_char(':');
+        fmt_dec2(secs >= 60 ? 59 : (uint8_t)secs);
+    }
+    fmt_pad(vidmem, LINELENGTH);
+
+    fmt_ptr = cursor;
+}
@@ -0,0 +1,68 @@
+/**************************************************************************
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   P2000T-RAMTESTER is free software:                                   *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   P2000T-RAMTESTER software is distributed in the hope that it will    *
+ *   be useful, but WITHOUT ANY WARRANTY; without even the implied        *
+ *   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#ifndef _PROGRESS_H
+#define _PROGRESS_H
+
+#include <stdint.h>
+
+#include "constants.h"
+#include "memory.h"
+#include "terminal.h"
+#include "format.h"
+#include "timing.h"
+#include "util.h"
+
+/*
+ * While a test runs, the status line at the top of the screen shows the test,
+ * a progress bar, the current bank and the estimated remaining time of the
+ * test. The line is redrawn from the interrupt handler once every
+ * PROGRESS_INTERVAL ticks (progress.asm), hence the test loops only count
+ * their bank selections (set_bank) and the cost of the display does not
+ * depend on the number of banks.
+ *
+ * Progress is measured in bank selections, of which every test announces the
+ * expected number; the remaining time is extrapolated from the elapsed time.
+ */
+
+#define PROGRESS_INTERVAL   25      // ticks between redraws, must match progress.asm
+#define PROGRESS_CELLS      16      // width of the progress bar
+
+extern volatile uint16_t progress_done;     // bank selections so far
+
+/**
+ * @brief Start showing the progress of a test on the status line
+ *
+ * @param test  test number
+ * @param total expected number of bank selections, 0 when unknown
+ */
+void progress_begin(uint8_t test, uint16_t total);
+
+/**
+ * @brief Stop showing progress and leave the final state on the status line
+ */
+void progress_end(void);
+
+/**
+ * @brief Draw the status line; called from the interrupt handler
+ */
+void progress_render(void);
+
+#endif // _PROGRESS_H
@@ -3,6 +3,84 @@
 
 #include <stdint.h>
 
+/**
+ * @brief Count the number of bytes in a memory region that differ from a
+ *        check byte
+ *
+ * @param memory  pointer to start of region
+ * @param val     check byte
+ * @param nrbytes number of bytes in region
+ * @return uint16_t number of miscounts
+ */
 uint16_t count_ram_bytes(char *memory, uint8_t val, uint16_t nrbytes) __z88dk_callee;
 
-#endif // _RAMTEST_H
\ No newline at end of file
+/**
+ * @brief Count the number of bytes in a memory region that differ from a
+ *        check byte and record up to fault_budget of them in the fault log
+ *        (see faultmap.h); runs at the speed of count_ram_bytes on a clean
+ *        region
+ *
+ * @param memory  pointer to start of region
+ * @param val     check byte
+ * @param nrbytes number of bytes in region
+ * @return uint16_t number of miscounts
+ */
+uint16_t count_ram_bytes_capture(char *memory, uint8_t val, uint16_t nrbytes) __z88dk_callee;
+
+/**
+ * @brief Fill a page-aligned memory region with a value unique to every
+ *        address, derived from the low and high byte of the address
+ *
+ * @param memory  pointer to start of region (page aligned)
+ * @param seed    seed mixed into every value, e.g. the bank number
+ * @param pages   number of 256-byte pages in region
+ */
+void fill_addr_pattern(char *memory, uint8_t seed, uint8_t pages) __z88dk_callee;
+
+/**
+ * @brief Count the number of bytes in a page-aligned memory region that
+ *        differ from the values written by fill_addr_pattern
+ *
+ * @param memory  pointer to start of region (page aligned)
+ * @param seed    seed used when writing the region
+ * @param pages   number of 256-byte pages in region
+ * @return uint16_t number of miscounts
+ */
+uint16_t count_addr_pattern(char *memory, uint8_t seed, uint8_t pages) __z88dk_callee;
+
+/**
+ * @brief Fill a page-aligned memory region with a pseudo-random stream of an
+ *        8-bit LFSR; the stream is fully determined by the seed
+ *
+ * @param memory  pointer to start of region (page aligned)
+ * @param seed    low byte: start state, high byte: key XORed into the stream
+ * @param pages   number of 256-byte pages in region
+ */
+void fill_lfsr_pattern(char *memory, uint16_t seed, uint8_t pages) __z88dk_callee;
+
+/**
+ * @brief Count the number of bytes in a page-aligned memory region that
+ *        differ from the values written by fill_lfsr_pattern, regenerating
+ *        the stream from the seed
+ *
+ * @param memory  pointer to start of region (page aligned)
+ * @param seed    seed used when writing the region
+ * @param pages   number of 256-byte pages in region
+ * @return uint16_t number of miscounts
+ */
+uint16_t count_lfsr_pattern(char *memory, uint16_t seed, uint8_t pages) __z88dk_callee;
+
+#define CRC16_INIT  0xFFFF  // initial value of a CRC-16/CCITT signature
+
+/**
+ * @brief Update a CRC-16/CCITT signature with the contents of a page-aligned
+ *        memory region
+ *
+ * @param memory  pointer to start of region (page aligned)
+ * @param crc     signature so far, CRC16_INIT for a new signature
+ * @param pages   number of 256-byte pages in region
+ * @return uint16_t updated signature
+ */
+uint16_t crc16_ram_pages(const char *memory, uint16_t crc, uint8_t pages) __z88dk_callee;
+
+#endif // _RAMTEST_H
@@ -0,0 +1,135 @@
+/**************************************************************************
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   P2000T-RAMTESTER is free software:                                   *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   P2000T-RAMTESTER software is distributed in the hope that it will    *
+ *   be useful, but WITHOUT ANY WARRANTY; without even the implied        *
+ *   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#include "registry.h"
+#include "march.h"
+
+uint16_t checks_run = 0;
+
+const test_t registry[] = {
+    // id  test                tier        checks                          fixed  high  bank  visits (high, bank, fixed)
+    { 3, ram_test_03,       TIER_BUS,   CHECK_BIT(CHECK_BANKREG),                 0,    0,    0,  0, 0, 0},
+    {13, ram_test_13,       TIER_BUS,   CHECK_BIT(CHECK_BUS),                     0,    0,    0,  0, 0, 1},
+    {14, ram_test_14,       TIER_PROBE, CHECK_BIT(CHECK_PROBE),                   0,    0,    5,  0, 2, 1},
+    {10, ram_test_10,       TIER_PROBE, CHECK_BIT(CHECK_STRIPE),                  0,  160,   80,  1, 4, 1},
+    { 4, ram_test_04,       TIER_DEEP,  CHECK_BIT(CHECK_REGION),               1870, 2550,    0,  1, 0, 2},
+    { 5, ram_test_05,       TIER_DEEP,  CHECK_BIT(CHECK_TAGS),                    0,    0,  240,  0, 2, 0},
+    { 6, ram_test_06,       TIER_DEEP,  CHECK_BIT(CHECK_PATTERN_55) |
+                                        CHECK_BIT(CHECK_PATTERN_AA),              0,    0,  480,  0, 3, 0},
+    { 7, ram_test_07,       TIER_DEEP,  CHECK_BIT(CHECK_PATTERN_00) |
+                                        CHECK_BIT(CHECK_PATTERN_FF),              0,    0,  480,  0, 3, 0},
+    {16, ram_test_pipeline, TIER_DEEP,  CHECK_BIT(CHECK_TAGS) | CHECK_BIT(CHECK_PATTERN_55) |
+                                        CHECK_BIT(CHECK_PATTERN_AA) | CHECK_BIT(CHECK_PATTERN_00) |
+                                        CHECK_BIT(CHECK_PATTERN_FF),              0,    0, 1200,  0, 2, 0},
+    { 8, ram_test_08,       TIER_DEEP,  CHECK_BIT(CHECK_ADDR),                    0,  786,  393,  1, 2, 1},
+    { 9, ram_test_09,       TIER_DEEP,  CHECK_BIT(CHECK_MARCH),                2320, 3160, 1463,
+      MARCH_C_MINUS_LEN, MARCH_C_MINUS_LEN, MARCH_C_MINUS_LEN},
+    {11, ram_test_11,       TIER_DEEP,  CHECK_BIT(CHECK_RANDOM),                  0, 1045,  522,  1, 2, 1},
+    {12, ram_test_12,       TIER_DEEP,  CHECK_BIT(CHECK_COPY),                 3790, 1102,  551,  1, 2, 1},
+    {15, ram_test_15,       TIER_DIAG,  CHECK_BIT(CHECK_DIAG),                    0,    0, 1280,  0, 0, 0},
+};
+
+const uint8_t registry_size = sizeof(registry) / sizeof(registry[0]);
+
+static uint32_t test_cost(const test_t *t, uint16_t nrbanks, uint8_t nrhighbanks) {
+    return t->fixed + (uint32_t)t->highbank * nrhighbanks + (uint32_t)t->bank * nrbanks;
+}
+
+uint32_t registry_cost(uint32_t tests, uint16_t nrbanks, uint8_t nrhighbanks) {
+    uint32_t kt = 0;
+    for(uint8_t i=0; i<registry_size; i++) {
+        if(tests & TEST_BIT(registry[i].id)) {
+            kt += test_cost(&registry[i], nrbanks, nrhighbanks);
+        }
+    }
+    return kt;
+}
+
+/**
+ * Return the cheapest test of a tier among a set of tests, NULL when the set
+ * holds no test of the tier
+ */
+static const test_t* registry_next(uint32_t tests, uint8_t tier, uint16_t nrbanks, uint8_t nrhighbanks) {
+    const test_t *next = NULL;
+    uint32_t best = 0;
+    for(uint8_t i=0; i<registry_size; i++) {
+        const test_t *t = &registry[i];
+        if(t->tier != tier || !(tests & TEST_BIT(t->id))) {
+            continue;
+        }
+        uint32_t cost = test_cost(t, nrbanks, nrhighbanks);
+        if(next == NULL || cost < best) {
+            next = t;
+            best = cost;
+        }
+    }
+    return next;
+}
+
+/**
+ * Run all tests of a tier among a set of tests, cheapest first; returns the
+ * set without the tests that ran
+ */
+static uint32_t registry_run_tier(uint32_t tests, uint8_t tier, uint16_t nrbanks, uint8_t nrhighbanks) {
+    const test_t *t;
+    while((t = registry_next(tests, tier, nrbanks, nrhighbanks)) != NULL) {
+        tests &= ~TEST_BIT(t->id);
+        checks_run |= t->checks;
+        run_test(t->id, t->run, t->visits_highbank * nrhighbanks + t->visits_bank * nrbanks + t->visits_fixed);
+    }
+    return tests;
+}
+
+/**
+ * Return whether any check of the tests that ran so far has failed
+ */
+static uint8_t registry_failed(void) {
+    for(uint8_t i=0; i<NR_CHECKS; i++) {
+        if((checks_run & CHECK_BIT(i)) && test_passed[i] != 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void registry_run(uint32_t tests, uint8_t full, uint16_t nrbanks, uint8_t nrhighbanks) {
+    tests = registry_run_tier(tests, TIER_BUS, nrbanks, nrhighbanks);
+    if(!full && registry_failed()) {
+        print_inline_color("Bus fault, remaining tests skipped", COL_RED);
+        return;
+    }
+
+    tests = registry_run_tier(tests, TIER_PROBE, nrbanks, nrhighbanks);
+    if(!full && registry_failed()) {
+        print_inline_color("Probe failed, diagnosing failing banks", COL_RED);
+        registry_run_tier(0xFFFFFFFF, TIER_DIAG, nrbanks, nrhighbanks);
+        return;
+    }
+
+    registry_run_tier(tests, TIER_DEEP, nrbanks, nrhighbanks);
+}
+
+void run_test(uint8_t id, void (*test)(void), uint16_t visits) {
+    progress_begin(id, visits);
+    timing_begin(id);
+    test();
+    timing_end();
+    progress_end();
+}
@@ -0,0 +1,147 @@
+/**************************************************************************
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   P2000T-RAMTESTER is free software:                                   *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   P2000T-RAMTESTER software is distributed in the hope that it will    *
+ *   be useful, but WITHOUT ANY WARRANTY; without even the implied        *
+ *   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#ifndef _REGISTRY_H
+#define _REGISTRY_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "constants.h"
+#include "terminal.h"
+#include "format.h"
+#include "timing.h"
+#include "progress.h"
+
+/*
+ * The tests that run after the board has been detected are listed in a
+ * registry, together with their tier, the checks of the summary they report,
+ * their estimated cost and their number of bank selections. The scheduler
+ * runs the tests of a profile tier by tier, the cheapest test first:
+ *
+ *   TIER_BUS    data lines of the bank register and the bank window; with a
+ *               faulty bus the results of all other tests are meaningless
+ *   TIER_PROBE  a few bytes per bank, catching dead, missing or aliased banks
+ *   TIER_DEEP   patterns over every byte of every bank
+ *   TIER_DIAG   patterns over the banks that failed the probe tier only
+ *
+ * Unless the profile asks for a full run, the scheduler stops after a tier in
+ * which a check failed: after the bus tier right away and after the probe
+ * tier once the failing banks have been diagnosed by the TIER_DIAG tests. A
+ * defective board is thus diagnosed in seconds instead of after the deep
+ * tests have swept every bank.
+ *
+ * Costs are in thousands of T-states, based on the kernel timings (see
+ * fill.asm and ramtest.asm; make bench reports the actual numbers per test).
+ */
+
+#define TIER_BUS            0
+#define TIER_PROBE          1
+#define TIER_DEEP           2
+#define TIER_DIAG           3
+
+#define TEST_BIT(id)        (1ul << (id))
+#define CHECK_BIT(check)    (1u << (check))
+
+// checks of the summary
+#define CHECK_TAGS          0   // test 5
+#define CHECK_PATTERN_55    1   // test 6
+#define CHECK_PATTERN_AA    2   // test 6
+#define CHECK_PATTERN_00    3   // test 7
+#define CHECK_PATTERN_FF    4   // test 7
+#define CHECK_ADDR          5   // test 8
+#define CHECK_MARCH         6   // test 9
+#define CHECK_STRIPE        7   // test 10
+#define CHECK_RANDOM        8   // test 11
+#define CHECK_COPY          9   // test 12
+#define CHECK_BUS           10  // test 13
+#define CHECK_PROBE         11  // test 14
+#define CHECK_DIAG          12  // test 15
+#define CHECK_BANKREG       13  // test 3
+#define CHECK_REGION        14  // test 4
+#define NR_CHECKS           15
+
+typedef struct {
+    uint8_t id;                 // test number
+    void (*run)(void);
+    uint8_t tier;               // one of the TIER_* values
+    uint16_t checks;            // bitmask of the checks of the summary
+    uint16_t fixed;             // thousands of T-states independent of the board
+    uint16_t highbank;          // thousands of T-states per 16 KiB high memory bank
+    uint16_t bank;              // thousands of T-states per 8 KiB bank
+    uint8_t visits_highbank;    // bank selections per 16 KiB high memory bank
+    uint8_t visits_bank;        // bank selections per 8 KiB bank
+    uint8_t visits_fixed;       // bank selections independent of the board
+} test_t;
+
+extern const test_t registry[];
+extern const uint8_t registry_size;
+
+extern uint16_t test_passed[NR_CHECKS];     // errors per check
+extern uint16_t checks_run;                 // bitmask of the checks of the tests that ran
+
+// tests, see main.c
+void ram_test_03(void);
+void ram_test_04(void);
+void ram_test_05(void);
+void ram_test_06(void);
+void ram_test_07(void);
+void ram_test_pipeline(void);
+void ram_test_08(void);
+void ram_test_09(void);
+void ram_test_10(void);
+void ram_test_11(void);
+void ram_test_12(void);
+void ram_test_13(void);
+void ram_test_14(void);
+void ram_test_15(void);
+
+/**
+ * @brief Projected cost of a set of tests
+ *
+ * @param tests       bitmask of test numbers, see TEST_BIT
+ * @param nrbanks     number of 8 KiB banks
+ * @param nrhighbanks number of 16 KiB high memory banks
+ * @return uint32_t thousands of T-states
+ */
+uint32_t registry_cost(uint32_t tests, uint16_t nrbanks, uint8_t nrhighbanks);
+
+/**
+ * @brief Run a set of tests tier by tier
+ *
+ * @param tests       bitmask of test numbers, see TEST_BIT
+ * @param full        run all tests, also after a failing tier
+ * @param nrbanks     number of 8 KiB banks
+ * @param nrhighbanks number of 16 KiB high memory banks
+ */
+void registry_run(uint32_t tests, uint8_t full, uint16_t nrbanks, uint8_t nrhighbanks);
+
+/**
+ * @brief Run a single test, showing its progress on the status line, and
+ *        record its elapsed time
+ *
+ * @param id     test number
+ * @param test   test function
+ * @param visits expected number of bank selections (set_bank), 0 when the
+ *               test does not sweep over the banks
+ */
+void run_test(uint8_t id, void (*test)(void), uint16_t visits);
+
+#endif // _REGISTRY_H
@@ -0,0 +1,75 @@
+;-------------------------------------------------------------------------------
+;
+;   Author: Ivo Filot <ivo@ivofilot.nl>
+;
+;   P2000T-RAMTESTER is free software:
+;   you can redistribute it and/or modify it under the terms of the
+;   GNU General Public License as published by the Free Software
+;   Foundation, either version 3 of the License, or (at your option)
+;   any later version.
+;
+;   P2000T-RAMTESTER software is distributed in the hope that it will
+;   be useful, but WITHOUT ANY WARRANTY; without even the implied
+;   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+;   See the GNU General Public License for more details.
+;
+;   You should have received a copy of the GNU General Public License
+;   along with this program.  If not, see http://www.gnu.org/licenses/.
+;
+;-------------------------------------------------------------------------------
+
+SECTION code_user
+
+PUBLIC _serial_isr
+
+EXTERN _serial_buf
+EXTERN _serial_head
+EXTERN _serial_tail
+
+defc SERIAL_PORT = 0x10         ; must match serial.h
+defc SERIAL_PORT_BITS = 0x40    ; keep the keyboard interrupt enabled
+defc SERIAL_BYTES_PER_TICK = 4
+defc SERIAL_BIT_DELAY = 12      ; 68 + 16 * 12 = 260 T-states per bit
+
+;-------------------------------------------------------------------------------
+; Interrupt hook that transmits up to SERIAL_BYTES_PER_TICK bytes from the
+; serial_buf ring buffer as 8N1 frames on bit 7 of SERIAL_PORT. Every bit
+; takes 260 T-states, i.e. 9615 baud at 2.5 MHz, such that four bytes occupy
+; about 4.2 ms of every 20 ms tick while the buffer holds data.
+;
+; Garbles: af, bc, de, hl
+;-------------------------------------------------------------------------------
+_serial_isr:
+    ld e,SERIAL_BYTES_PER_TICK
+serial_next:
+    ld a,(_serial_tail)
+    ld hl,_serial_head
+    cp (hl)
+    ret z                       ; buffer is empty
+    ld c,a
+    ld b,0
+    ld hl,_serial_buf
+    add hl,bc
+    ld l,(hl)                   ; byte to transmit
+    inc a
+    ld (_serial_tail),a         ; release the slot to the producer
+    ld h,0x01
+    add hl,hl                   ; hl = stop bit, data bits and start bit
+    ld b,10
+serial_bit:
+    ld a,l                      ; 4
+    rrca                        ; 4     next bit onto bit 7
+    and 0x80                    ; 7
+    or SERIAL_PORT_BITS         ; 7
+    out (SERIAL_PORT),a         ; 11
+    srl h                       ; 8
+    rr l                        ; 8
+    ld a,SERIAL_BIT_DELAY       ; 7
+serial_delay:
+    dec a                       ; 4
+    jr nz,serial_delay          ; 12/7
+    nop                         ; 4
+    djnz serial_bit             ; 13
+    dec e
+    jr nz,serial_next
+    ret
@@ -0,0 +1,99 @@
+/**************************************************************************
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   P2000T-RAMTESTER is free software:                                   *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   P2000T-RAMTESTER software is distributed in the hope that it will    *
+ *   be useful, but WITHOUT ANY WARRANTY; without even the implied        *
+ *   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#include "serial.h"
+
+uint8_t serial_buf[SERIAL_BUF_SIZE];
+volatile uint8_t serial_head = 0;
+volatile uint8_t serial_tail = 0;
+
+static char _serial_line[SERIAL_LINE_MAX];
+static char* _serial_cursor = 0;    // format cursor to restore after the record
+
+void serial_init(void) {
+    z80_outp(SERIAL_PORT, SERIAL_IDLE);
+    isr_install();
+
+    serial_begin('H');
+    serial_field_str("RAMTEST");
+    serial_field_str(__VERSION__);
+    serial_end();
+}
+
+/*
+ * Records are composed with the format emitters, hence the format cursor is
+ * saved here and restored by serial_end, which allows emitting a record while
+ * a line on the screen is being written.
+ */
+void serial_begin(char type) {
+    _serial_cursor = fmt_ptr;
+    fmt_at(_serial_line);
+    fmt_char('$');
+    fmt_char(type);
+}
+
+void serial_field_dec(uint16_t val) {
+    fmt_char(',');
+    fmt_dec(val, 0);
+}
+
+void serial_field_dec32(uint32_t val) {
+    fmt_char(',');
+    fmt_dec32(val, 0);
+}
+
+void serial_field_hex8(uint8_t val) {
+    fmt_char(',');
+    fmt_hex8(val);
+}
+
+void serial_field_hex16(uint16_t val) {
+    fmt_char(',');
+    fmt_hex16(val);
+}
+
+void serial_field_str(const char* str) {
+    fmt_char(',');
+    fmt_str(str);
+}
+
+void serial_end(void) {
+    uint8_t sum = 0;
+    for(const char* p = &_serial_line[1]; p != fmt_ptr; p++) {
+        sum ^= *p;
+    }
+    fmt_char('*');
+    fmt_hex8(sum);
+    fmt_char('\r');
+    fmt_char('\n');
+
+    for(const char* p = _serial_line; p != fmt_ptr; p++) {
+        // one slot is kept free to tell a full buffer from an empty one
+        while((uint8_t)(serial_head + 1) == serial_tail) {}
+        serial_buf[serial_head] = *p;
+        serial_head++;
+    }
+
+    fmt_ptr = _serial_cursor;
+}
+
+void serial_flush(void) {
+    while(serial_head != serial_tail) {}
+}
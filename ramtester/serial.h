@@ -0,0 +1,125 @@
+/**************************************************************************
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   P2000T-RAMTESTER is free software:                                   *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   P2000T-RAMTESTER software is distributed in the hope that it will    *
+ *   be useful, but WITHOUT ANY WARRANTY; without even the implied        *
+ *   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#ifndef _SERIAL_H
+#define _SERIAL_H
+
+#include <stdint.h>
+
+#include "config.h"
+#include "format.h"
+#include "interrupt.h"
+#include "z80.h"
+
+/*
+ * Results are exported as lines of text over the serial (printer) output of
+ * the P2000T, such that a host can collect them via a USB-serial adapter,
+ * see collect.py. Every record has the form
+ *
+ *   $<type>,<field>,...*<checksum>\r\n
+ *
+ * where the checksum is the XOR of all characters between '$' and '*' in
+ * two hexadecimal digits. Record types:
+ *
+ *   H,RAMTEST,<version>              start of a run
+ *   B,<banks>,<high banks>           detected number of 8 KiB and 16 KiB banks
+ *   P,<profile>                      selected test profile, see profile.h
+ *   T,<test>,<ticks>,<KiB>           elapsed ticks and data processed by a test
+ *   L,<seed>                         seed of the random data test (hexadecimal)
+ *   R,<check>,<errors>               errors per check of the summary
+ *   G,<first bank>,<states>          16 banks: P(ass), F(ail) or - (untested)
+ *   S,<total>,<D7>,...,<D0>          failing bytes, recorded faults per data bit
+ *   C,<base>,<chip 1>,...            failing bytes per chip
+ *   F,<addr>,<bank>,<mask>           fault record (hexadecimal)
+ *   E,<failed checks>                end of a run
+ *   I,<pass>,<ticks>,<errors>        burn-in pass, see soak.h
+ *   K,<row>,<errors>,<first>,<fails> burn-in table row of a bank that failed
+ *                                    in the pass; rows 100 and 101 are the
+ *                                    high memory banks (hexadecimal row)
+ *
+ * Records are queued in a ring buffer, which is drained from the interrupt
+ * handler at 9615 baud, 8N1 (serial.asm). The tests therefore never wait for
+ * the serial line, unless the buffer is full.
+ *
+ * Assumptions on the hardware: the line is driven by bit 7 of port 0x10 with
+ * a 1 (mark) as idle level, and bit 6 of the same port enables the keyboard
+ * interrupt. Other bits of port 0x10 (cassette control) are held low.
+ */
+
+#define SERIAL_PORT         0x10    // must match serial.asm
+#define SERIAL_IDLE         0xC0    // line at mark, keyboard interrupt enabled
+#define SERIAL_BUF_SIZE     256     // ring buffer indexed by a uint8_t
+#define SERIAL_LINE_MAX     64      // longest record including "*XX\r\n"
+
+extern uint8_t serial_buf[SERIAL_BUF_SIZE];
+extern volatile uint8_t serial_head;    // next byte to write
+extern volatile uint8_t serial_tail;    // next byte to transmit
+
+/**
+ * @brief Set the line to idle, install the interrupt handler and emit the
+ *        header record
+ */
+void serial_init(void);
+
+/**
+ * @brief Start a record; fields are appended with the serial_field_*
+ *        functions
+ *
+ * @param type record type
+ */
+void serial_begin(char type);
+
+/**
+ * @brief Append a decimal field
+ */
+void serial_field_dec(uint16_t val);
+
+/**
+ * @brief Append a decimal field of a 32-bit value
+ */
+void serial_field_dec32(uint32_t val);
+
+/**
+ * @brief Append a two-digit hexadecimal field
+ */
+void serial_field_hex8(uint8_t val);
+
+/**
+ * @brief Append a four-digit hexadecimal field
+ */
+void serial_field_hex16(uint16_t val);
+
+/**
+ * @brief Append a text field
+ */
+void serial_field_str(const char* str);
+
+/**
+ * @brief Terminate the record and queue it for transmission; waits while
+ *        the ring buffer is full
+ */
+void serial_end(void);
+
+/**
+ * @brief Wait until all queued records have been transmitted
+ */
+void serial_flush(void);
+
+#endif // _SERIAL_H
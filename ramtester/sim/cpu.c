@@ -0,0 +1,821 @@
+/**************************************************************************
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   P2000T-RAMTESTER is free software:                                   *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   P2000T-RAMTESTER software is distributed in the hope that it will    *
+ *   be useful, but WITHOUT ANY WARRANTY; without even the implied        *
+ *   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+/*
+ * Z80 instruction set emulator, including the undocumented IXH/IXL/IYH/IYL
+ * registers and DDCB/FDCB register copies. Timing follows the documented
+ * T-state counts per instruction; memory contention is absent on the P2000T.
+ */
+
+#include <stddef.h>
+
+#include "cpu.h"
+
+#define RD(a)       cpu->read(cpu->ctx, (uint16_t)(a))
+#define WR(a, v)    cpu->write(cpu->ctx, (uint16_t)(a), (uint8_t)(v))
+
+#define BC          ((uint16_t)((cpu->b << 8) | cpu->c))
+#define DE          ((uint16_t)((cpu->d << 8) | cpu->e))
+#define HL          ((uint16_t)((cpu->h << 8) | cpu->l))
+#define AF          ((uint16_t)((cpu->a << 8) | cpu->f))
+
+#define SET_BC(v)   do { uint16_t _v = (v); cpu->b = _v >> 8; cpu->c = (uint8_t)_v; } while(0)
+#define SET_DE(v)   do { uint16_t _v = (v); cpu->d = _v >> 8; cpu->e = (uint8_t)_v; } while(0)
+#define SET_HL(v)   do { uint16_t _v = (v); cpu->h = _v >> 8; cpu->l = (uint8_t)_v; } while(0)
+#define SET_AF(v)   do { uint16_t _v = (v); cpu->a = _v >> 8; cpu->f = (uint8_t)_v; } while(0)
+
+#define XY          (FLAG_X | FLAG_Y)
+
+// base T-states of the unprefixed instructions; conditional branches list
+// the cost of the branch not being taken
+static const uint8_t cyc_main[256] = {
+     4,10, 7, 6, 4, 4, 7, 4, 4,11, 7, 6, 4, 4, 7, 4,
+     8,10, 7, 6, 4, 4, 7, 4,12,11, 7, 6, 4, 4, 7, 4,
+     7,10,16, 6, 4, 4, 7, 4, 7,11,16, 6, 4, 4, 7, 4,
+     7,10,13, 6,11,11,10, 4, 7,11,13, 6, 4, 4, 7, 4,
+     4, 4, 4, 4, 4, 4, 7, 4, 4, 4, 4, 4, 4, 4, 7, 4,
+     4, 4, 4, 4, 4, 4, 7, 4, 4, 4, 4, 4, 4, 4, 7, 4,
+     4, 4, 4, 4, 4, 4, 7, 4, 4, 4, 4, 4, 4, 4, 7, 4,
+     7, 7, 7, 7, 7, 7, 4, 7, 4, 4, 4, 4, 4, 4, 7, 4,
+     4, 4, 4, 4, 4, 4, 7, 4, 4, 4, 4, 4, 4, 4, 7, 4,
+     4, 4, 4, 4, 4, 4, 7, 4, 4, 4, 4, 4, 4, 4, 7, 4,
+     4, 4, 4, 4, 4, 4, 7, 4, 4, 4, 4, 4, 4, 4, 7, 4,
+     4, 4, 4, 4, 4, 4, 7, 4, 4, 4, 4, 4, 4, 4, 7, 4,
+     5,10,10,10,10,11, 7,11, 5,10,10, 0,10,17, 7,11,
+     5,10,10,11,10,11, 7,11, 5, 4,10,11,10, 0, 7,11,
+     5,10,10,19,10,11, 7,11, 5, 4,10, 4,10, 0, 7,11,
+     5,10,10, 4,10,11, 7,11, 5, 6,10, 4,10, 0, 7,11,
+};
+
+static uint8_t sz53[256];       // S, Z, X and Y flags of a result
+static uint8_t sz53p[256];      // idem, including parity
+static int tables_ready = 0;
+
+static void init_tables(void) {
+    for(int i=0; i<256; i++) {
+        uint8_t p = 0;
+        for(int j=0; j<8; j++) {
+            p ^= (i >> j) & 1;
+        }
+        sz53[i] = (uint8_t)((i & (FLAG_S | XY)) | (i == 0 ? FLAG_Z : 0));
+        sz53p[i] = sz53[i] | (p ? 0 : FLAG_P);
+    }
+    tables_ready = 1;
+}
+
+static inline uint8_t fetch(cpu_t *cpu) {
+    return RD(cpu->pc++);
+}
+
+static inline uint16_t fetch16(cpu_t *cpu) {
+    uint8_t lo = fetch(cpu);
+    return (uint16_t)(lo | (fetch(cpu) << 8));
+}
+
+static inline uint16_t read16(cpu_t *cpu, uint16_t addr) {
+    return (uint16_t)(RD(addr) | (RD(addr + 1) << 8));
+}
+
+static inline void write16(cpu_t *cpu, uint16_t addr, uint16_t v) {
+    WR(addr, v & 0xFF);
+    WR(addr + 1, v >> 8);
+}
+
+static inline void push(cpu_t *cpu, uint16_t v) {
+    cpu->sp -= 2;
+    write16(cpu, cpu->sp, v);
+}
+
+static inline uint16_t pop(cpu_t *cpu) {
+    uint16_t v = read16(cpu, cpu->sp);
+    cpu->sp += 2;
+    return v;
+}
+
+static inline void inc_r(cpu_t *cpu) {
+    cpu->r = (uint8_t)((cpu->r & 0x80) | ((cpu->r + 1) & 0x7F));
+}
+
+/*
+ * Arithmetic and logic
+ */
+static inline void alu_add(cpu_t *cpu, uint8_t v, uint8_t carry) {
+    unsigned r = cpu->a + v + carry;
+    uint8_t res = (uint8_t)r;
+    cpu->f = sz53[res] | ((cpu->a ^ v ^ res) & FLAG_H) |
+             ((((cpu->a ^ ~v) & (cpu->a ^ res)) & 0x80) ? FLAG_P : 0) |
+             ((r >> 8) & FLAG_C);
+    cpu->a = res;
+}
+
+static inline uint8_t alu_sub(cpu_t *cpu, uint8_t v, uint8_t carry) {
+    unsigned r = cpu->a - v - carry;
+    uint8_t res = (uint8_t)r;
+    cpu->f = FLAG_N | sz53[res] | ((cpu->a ^ v ^ res) & FLAG_H) |
+             ((((cpu->a ^ v) & (cpu->a ^ res)) & 0x80) ? FLAG_P : 0) |
+             ((r >> 8) & FLAG_C);
+    return res;
+}
+
+static void alu(cpu_t *cpu, int op, uint8_t v) {
+    switch(op) {
+        case 0: alu_add(cpu, v, 0); break;
+        case 1: alu_add(cpu, v, cpu->f & FLAG_C); break;
+        case 2: cpu->a = alu_sub(cpu, v, 0); break;
+        case 3: cpu->a = alu_sub(cpu, v, cpu->f & FLAG_C); break;
+        case 4: cpu->a &= v; cpu->f = sz53p[cpu->a] | FLAG_H; break;
+        case 5: cpu->a ^= v; cpu->f = sz53p[cpu->a]; break;
+        case 6: cpu->a |= v; cpu->f = sz53p[cpu->a]; break;
+        case 7:
+            alu_sub(cpu, v, 0);
+            cpu->f = (uint8_t)((cpu->f & ~XY) | (v & XY));
+            break;
+    }
+}
+
+static inline uint8_t inc8(cpu_t *cpu, uint8_t v) {
+    uint8_t r = (uint8_t)(v + 1);
+    cpu->f = (cpu->f & FLAG_C) | sz53[r] | ((r & 0x0F) == 0 ? FLAG_H : 0) |
+             (r == 0x80 ? FLAG_P : 0);
+    return r;
+}
+
+static inline uint8_t dec8(cpu_t *cpu, uint8_t v) {
+    uint8_t r = (uint8_t)(v - 1);
+    cpu->f = (cpu->f & FLAG_C) | FLAG_N | sz53[r] | ((v & 0x0F) == 0 ? FLAG_H : 0) |
+             (v == 0x80 ? FLAG_P : 0);
+    return r;
+}
+
+static inline uint16_t add16(cpu_t *cpu, uint16_t a, uint16_t v) {
+    uint32_t r = (uint32_t)a + v;
+    cpu->f = (cpu->f & (FLAG_S | FLAG_Z | FLAG_P)) | ((r >> 8) & XY) |
+             (((a ^ v ^ r) >> 8) & FLAG_H) | ((r >> 16) & FLAG_C);
+    return (uint16_t)r;
+}
+
+static inline uint16_t adc16(cpu_t *cpu, uint16_t a, uint16_t v) {
+    uint32_t r = (uint32_t)a + v + (cpu->f & FLAG_C);
+    uint16_t res = (uint16_t)r;
+    cpu->f = ((res >> 8) & (FLAG_S | XY)) | (res == 0 ? FLAG_Z : 0) |
+             (((a ^ v ^ r) >> 8) & FLAG_H) |
+             ((~(a ^ v) & (a ^ res) & 0x8000) ? FLAG_P : 0) | ((r >> 16) & FLAG_C);
+    return res;
+}
+
+static inline uint16_t sbc16(cpu_t *cpu, uint16_t a, uint16_t v) {
+    uint32_t r = (uint32_t)a - v - (cpu->f & FLAG_C);
+    uint16_t res = (uint16_t)r;
+    cpu->f = FLAG_N | ((res >> 8) & (FLAG_S | XY)) | (res == 0 ? FLAG_Z : 0) |
+             (((a ^ v ^ r) >> 8) & FLAG_H) |
+             (((a ^ v) & (a ^ res) & 0x8000) ? FLAG_P : 0) | ((r >> 16) & FLAG_C);
+    return res;
+}
+
+static uint8_t rot(cpu_t *cpu, int op, uint8_t v) {
+    uint8_t c;
+    switch(op) {
+        case 0: c = v >> 7; v = (uint8_t)((v << 1) | c); break;                     // RLC
+        case 1: c = v & 1; v = (uint8_t)((v >> 1) | (c << 7)); break;               // RRC
+        case 2: c = v >> 7; v = (uint8_t)((v << 1) | (cpu->f & FLAG_C)); break;     // RL
+        case 3: c = v & 1; v = (uint8_t)((v >> 1) | ((cpu->f & FLAG_C) << 7)); break; // RR
+        case 4: c = v >> 7; v = (uint8_t)(v << 1); break;                           // SLA
+        case 5: c = v & 1; v = (uint8_t)((v >> 1) | (v & 0x80)); break;             // SRA
+        case 6: c = v >> 7; v = (uint8_t)((v << 1) | 1); break;                     // SLL
+        default: c = v & 1; v = (uint8_t)(v >> 1); break;                           // SRL
+    }
+    cpu->f = sz53p[v] | c;
+    return v;
+}
+
+static void bit(cpu_t *cpu, int n, uint8_t v) {
+    uint8_t r = v & (uint8_t)(1 << n);
+    cpu->f = (cpu->f & FLAG_C) | FLAG_H | (v & XY) |
+             (r == 0 ? (FLAG_Z | FLAG_P) : 0) | (r & FLAG_S);
+}
+
+static void daa(cpu_t *cpu) {
+    uint8_t a = cpu->a;
+    uint8_t corr = 0;
+    uint8_t carry = cpu->f & FLAG_C;
+    uint8_t half;
+
+    if((cpu->f & FLAG_H) || (a & 0x0F) > 9) {
+        corr = 0x06;
+    }
+    if(carry || a > 0x99) {
+        corr |= 0x60;
+        carry = FLAG_C;
+    }
+    if(cpu->f & FLAG_N) {
+        half = ((cpu->f & FLAG_H) && (a & 0x0F) < 6) ? FLAG_H : 0;
+        a = (uint8_t)(a - corr);
+    } else {
+        half = ((a & 0x0F) > 9) ? FLAG_H : 0;
+        a = (uint8_t)(a + corr);
+    }
+    cpu->a = a;
+    cpu->f = sz53p[a] | carry | half | (cpu->f & FLAG_N);
+}
+
+static int condition(cpu_t *cpu, int cc) {
+    switch(cc) {
+        case 0: return !(cpu->f & FLAG_Z);
+        case 1: return (cpu->f & FLAG_Z) != 0;
+        case 2: return !(cpu->f & FLAG_C);
+        case 3: return (cpu->f & FLAG_C) != 0;
+        case 4: return !(cpu->f & FLAG_P);
+        case 5: return (cpu->f & FLAG_P) != 0;
+        case 6: return !(cpu->f & FLAG_S);
+        default: return (cpu->f & FLAG_S) != 0;
+    }
+}
+
+/*
+ * Register access; with an index prefix H and L refer to the upper and lower
+ * half of IX or IY.
+ */
+static uint8_t get_reg(cpu_t *cpu, int r, uint16_t *xy) {
+    switch(r) {
+        case 0: return cpu->b;
+        case 1: return cpu->c;
+        case 2: return cpu->d;
+        case 3: return cpu->e;
+        case 4: return xy ? (uint8_t)(*xy >> 8) : cpu->h;
+        case 5: return xy ? (uint8_t)*xy : cpu->l;
+        default: return cpu->a;
+    }
+}
+
+static void set_reg(cpu_t *cpu, int r, uint8_t v, uint16_t *xy) {
+    switch(r) {
+        case 0: cpu->b = v; break;
+        case 1: cpu->c = v; break;
+        case 2: cpu->d = v; break;
+        case 3: cpu->e = v; break;
+        case 4: if(xy) { *xy = (uint16_t)((*xy & 0x00FF) | (v << 8)); } else { cpu->h = v; } break;
+        case 5: if(xy) { *xy = (uint16_t)((*xy & 0xFF00) | v); } else { cpu->l = v; } break;
+        default: cpu->a = v; break;
+    }
+}
+
+static uint16_t get_rp(cpu_t *cpu, int p, uint16_t *xy) {
+    switch(p) {
+        case 0: return BC;
+        case 1: return DE;
+        case 2: return xy ? *xy : HL;
+        default: return cpu->sp;
+    }
+}
+
+static void set_rp(cpu_t *cpu, int p, uint16_t v, uint16_t *xy) {
+    switch(p) {
+        case 0: SET_BC(v); break;
+        case 1: SET_DE(v); break;
+        case 2: if(xy) { *xy = v; } else { SET_HL(v); } break;
+        default: cpu->sp = v; break;
+    }
+}
+
+/*
+ * CB-prefixed instructions; with an index prefix the operand is always
+ * (IX+d) and the result is also copied into the register (undocumented).
+ */
+static int exec_cb(cpu_t *cpu, uint16_t *xy) {
+    uint16_t addr = 0;
+    uint8_t op, v;
+
+    if(xy) {
+        addr = (uint16_t)(*xy + (int8_t)fetch(cpu));
+        op = fetch(cpu);
+    } else {
+        op = fetch(cpu);
+        inc_r(cpu);
+    }
+
+    int x = op >> 6, y = (op >> 3) & 7, z = op & 7;
+    int mem = xy || z == 6;
+
+    if(mem) {
+        if(!xy) {
+            addr = HL;
+        }
+        v = RD(addr);
+    } else {
+        v = get_reg(cpu, z, NULL);
+    }
+
+    switch(x) {
+        case 0: v = rot(cpu, y, v); break;
+        case 1:
+            bit(cpu, y, v);
+            return xy ? 20 : (mem ? 12 : 8);
+        case 2: v &= (uint8_t)~(1 << y); break;
+        default: v |= (uint8_t)(1 << y); break;
+    }
+
+    if(mem) {
+        WR(addr, v);
+        if(xy && z != 6) {
+            set_reg(cpu, z, v, NULL);
+        }
+        return xy ? 23 : 15;
+    }
+    set_reg(cpu, z, v, NULL);
+    return 8;
+}
+
+/*
+ * Block transfer, compare and I/O instructions
+ */
+static int exec_block(cpu_t *cpu, int y, int z) {
+    int dir = (y & 1) ? -1 : 1;
+    int repeat = y >= 6;
+    uint8_t v;
+
+    switch(z) {
+        case 0: { // LDI, LDD, LDIR, LDDR
+            v = RD(HL);
+            WR(DE, v);
+            SET_HL(HL + dir);
+            SET_DE(DE + dir);
+            SET_BC(BC - 1);
+            uint8_t n = (uint8_t)(v + cpu->a);
+            cpu->f = (cpu->f & (FLAG_S | FLAG_Z | FLAG_C)) | (BC ? FLAG_P : 0) |
+                     (n & FLAG_X) | ((n & 0x02) << 4);
+            if(repeat && BC) {
+                cpu->pc -= 2;
+                return 21;
+            }
+            return 16;
+        }
+        case 1: { // CPI, CPD, CPIR, CPDR
+            v = RD(HL);
+            uint8_t r = (uint8_t)(cpu->a - v);
+            uint8_t half = (cpu->a ^ v ^ r) & FLAG_H;
+            uint8_t n = (uint8_t)(r - (half ? 1 : 0));
+            SET_HL(HL + dir);
+            SET_BC(BC - 1);
+            cpu->f = (cpu->f & FLAG_C) | FLAG_N | (sz53[r] & (FLAG_S | FLAG_Z)) | half |
+                     (BC ? FLAG_P : 0) | (n & FLAG_X) | ((n & 0x02) << 4);
+            if(repeat && BC && r != 0) {
+                cpu->pc -= 2;
+                return 21;
+            }
+            return 16;
+        }
+        case 2: // INI, IND, INIR, INDR
+            v = cpu->in(cpu->ctx, BC);
+            WR(HL, v);
+            SET_HL(HL + dir);
+            cpu->b--;
+            cpu->f = (uint8_t)((sz53[cpu->b] & ~FLAG_P) | FLAG_N | (cpu->f & FLAG_C));
+            if(repeat && cpu->b) {
+                cpu->pc -= 2;
+                return 21;
+            }
+            return 16;
+        default: // OUTI, OUTD, OTIR, OTDR
+            v = RD(HL);
+            cpu->b--;
+            cpu->out(cpu->ctx, BC, v);
+            SET_HL(HL + dir);
+            cpu->f = (uint8_t)((sz53[cpu->b] & ~FLAG_P) | FLAG_N | (cpu->f & FLAG_C));
+            if(repeat && cpu->b) {
+                cpu->pc -= 2;
+                return 21;
+            }
+            return 16;
+    }
+}
+
+/*
+ * ED-prefixed instructions
+ */
+static int exec_ed(cpu_t *cpu) {
+    uint8_t op = fetch(cpu);
+    inc_r(cpu);
+
+    int x = op >> 6, y = (op >> 3) & 7, z = op & 7;
+    int p = y >> 1, q = y & 1;
+
+    if(x == 2 && z <= 3 && y >= 4) {
+        return exec_block(cpu, y, z);
+    }
+    if(x != 1) {
+        return 8; // undefined, acts as a double NOP
+    }
+
+    switch(z) {
+        case 0: { // IN r,(C)
+            uint8_t v = cpu->in(cpu->ctx, BC);
+            if(y != 6) {
+                set_reg(cpu, y, v, NULL);
+            }
+            cpu->f = (cpu->f & FLAG_C) | sz53p[v];
+            return 12;
+        }
+        case 1: // OUT (C),r
+            cpu->out(cpu->ctx, BC, y == 6 ? 0 : get_reg(cpu, y, NULL));
+            return 12;
+        case 2:
+            if(q == 0) {
+                SET_HL(sbc16(cpu, HL, get_rp(cpu, p, NULL)));
+            } else {
+                SET_HL(adc16(cpu, HL, get_rp(cpu, p, NULL)));
+            }
+            return 15;
+        case 3: {
+            uint16_t addr = fetch16(cpu);
+            if(q == 0) {
+                write16(cpu, addr, get_rp(cpu, p, NULL));
+            } else {
+                set_rp(cpu, p, read16(cpu, addr), NULL);
+            }
+            return 20;
+        }
+        case 4: { // NEG
+            uint8_t v = cpu->a;
+            cpu->a = 0;
+            cpu->a = alu_sub(cpu, v, 0);
+            return 8;
+        }
+        case 5: // RETN, RETI
+            cpu->iff1 = cpu->iff2;
+            cpu->pc = pop(cpu);
+            return 14;
+        case 6: {
+            static const uint8_t modes[8] = {0, 0, 1, 2, 0, 0, 1, 2};
+            cpu->im = modes[y];
+            return 8;
+        }
+        default:
+            switch(y) {
+                case 0: cpu->i = cpu->a; return 9;
+                case 1: cpu->r = cpu->a; return 9;
+                case 2:
+                case 3:
+                    cpu->a = (y == 2) ? cpu->i : cpu->r;
+                    cpu->f = (cpu->f & FLAG_C) | sz53[cpu->a] | (cpu->iff2 ? FLAG_P : 0);
+                    return 9;
+                case 4: { // RRD
+                    uint8_t v = RD(HL);
+                    WR(HL, (uint8_t)((cpu->a << 4) | (v >> 4)));
+                    cpu->a = (uint8_t)((cpu->a & 0xF0) | (v & 0x0F));
+                    cpu->f = (cpu->f & FLAG_C) | sz53p[cpu->a];
+                    return 18;
+                }
+                case 5: { // RLD
+                    uint8_t v = RD(HL);
+                    WR(HL, (uint8_t)((v << 4) | (cpu->a & 0x0F)));
+                    cpu->a = (uint8_t)((cpu->a & 0xF0) | (v >> 4));
+                    cpu->f = (cpu->f & FLAG_C) | sz53p[cpu->a];
+                    return 18;
+                }
+                default:
+                    return 8;
+            }
+    }
+}
+
+/*
+ * Unprefixed instructions, or instructions with a DD/FD prefix when xy is set
+ */
+static int exec_main(cpu_t *cpu, uint8_t op, uint16_t *xy) {
+    int x = op >> 6, y = (op >> 3) & 7, z = op & 7;
+    int p = y >> 1, q = y & 1;
+    int cycles = cyc_main[op];
+    uint16_t addr;
+
+    // memory operand (HL) or (IX+d)
+    #define MEMADDR() (xy ? (cycles += 8, (uint16_t)(*xy + (int8_t)fetch(cpu))) : HL)
+
+    switch(x) {
+    case 0:
+        switch(z) {
+        case 0:
+            switch(y) {
+                case 0: break;
+                case 1: {
+                    uint8_t t;
+                    t = cpu->a; cpu->a = cpu->a_; cpu->a_ = t;
+                    t = cpu->f; cpu->f = cpu->f_; cpu->f_ = t;
+                    break;
+                }
+                case 2: {
+                    int8_t d = (int8_t)fetch(cpu);
+                    if(--cpu->b != 0) {
+                        cpu->pc = (uint16_t)(cpu->pc + d);
+                        cycles += 5;
+                    }
+                    break;
+                }
+                case 3: {
+                    int8_t d = (int8_t)fetch(cpu);
+                    cpu->pc = (uint16_t)(cpu->pc + d);
+                    break;
+                }
+                default: {
+                    int8_t d = (int8_t)fetch(cpu);
+                    if(condition(cpu, y - 4)) {
+                        cpu->pc = (uint16_t)(cpu->pc + d);
+                        cycles += 5;
+                    }
+                    break;
+                }
+            }
+            break;
+        case 1:
+            if(q == 0) {
+                set_rp(cpu, p, fetch16(cpu), xy);
+            } else {
+                uint16_t v = add16(cpu, get_rp(cpu, 2, xy), get_rp(cpu, p, xy));
+                set_rp(cpu, 2, v, xy);
+            }
+            break;
+        case 2:
+            switch(y) {
+                case 0: WR(BC, cpu->a); break;
+                case 1: cpu->a = RD(BC); break;
+                case 2: WR(DE, cpu->a); break;
+                case 3: cpu->a = RD(DE); break;
+                case 4: write16(cpu, fetch16(cpu), get_rp(cpu, 2, xy)); break;
+                case 5: set_rp(cpu, 2, read16(cpu, fetch16(cpu)), xy); break;
+                case 6: WR(fetch16(cpu), cpu->a); break;
+                default: cpu->a = RD(fetch16(cpu)); break;
+            }
+            break;
+        case 3:
+            set_rp(cpu, p, (uint16_t)(get_rp(cpu, p, xy) + (q ? -1 : 1)), xy);
+            break;
+        case 4:
+        case 5:
+            if(y == 6) {
+                addr = MEMADDR();
+                WR(addr, z == 4 ? inc8(cpu, RD(addr)) : dec8(cpu, RD(addr)));
+            } else {
+                uint8_t v = get_reg(cpu, y, xy);
+                set_reg(cpu, y, z == 4 ? inc8(cpu, v) : dec8(cpu, v), xy);
+            }
+            break;
+        case 6:
+            if(y == 6) {
+                addr = MEMADDR();
+                if(xy) {
+                    cycles -= 3;    // LD (IX+d),n takes 19 T-states
+                }
+                WR(addr, fetch(cpu));
+            } else {
+                set_reg(cpu, y, fetch(cpu), xy);
+            }
+            break;
+        default:
+            switch(y) {
+                case 0: {
+                    uint8_t c = cpu->a >> 7;
+                    cpu->a = (uint8_t)((cpu->a << 1) | c);
+                    cpu->f = (cpu->f & (FLAG_S | FLAG_Z | FLAG_P)) | (cpu->a & XY) | c;
+                    break;
+                }
+                case 1: {
+                    uint8_t c = cpu->a & 1;
+                    cpu->a = (uint8_t)((cpu->a >> 1) | (c << 7));
+                    cpu->f = (cpu->f & (FLAG_S | FLAG_Z | FLAG_P)) | (cpu->a & XY) | c;
+                    break;
+                }
+                case 2: {
+                    uint8_t c = cpu->a >> 7;
+                    cpu->a = (uint8_t)((cpu->a << 1) | (cpu->f & FLAG_C));
+                    cpu->f = (cpu->f & (FLAG_S | FLAG_Z | FLAG_P)) | (cpu->a & XY) | c;
+                    break;
+                }
+                case 3: {
+                    uint8_t c = cpu->a & 1;
+                    cpu->a = (uint8_t)((cpu->a >> 1) | ((cpu->f & FLAG_C) << 7));
+                    cpu->f = (cpu->f & (FLAG_S | FLAG_Z | FLAG_P)) | (cpu->a & XY) | c;
+                    break;
+                }
+                case 4: daa(cpu); break;
+                case 5:
+                    cpu->a = (uint8_t)~cpu->a;
+                    cpu->f = (cpu->f & (FLAG_S | FLAG_Z | FLAG_P | FLAG_C)) | FLAG_H | FLAG_N |
+                             (cpu->a & XY);
+                    break;
+                case 6:
+                    cpu->f = (cpu->f & (FLAG_S | FLAG_Z | FLAG_P)) | FLAG_C | (cpu->a & XY);
+                    break;
+                default:
+                    cpu->f = (cpu->f & (FLAG_S | FLAG_Z | FLAG_P)) |
+                             ((cpu->f & FLAG_C) ? FLAG_H : FLAG_C) | (cpu->a & XY);
+                    break;
+            }
+            break;
+        }
+        break;
+
+    case 1:
+        if(y == 6 && z == 6) {
+            cpu->halted = 1;
+        } else if(y == 6) {
+            addr = MEMADDR();
+            WR(addr, get_reg(cpu, z, NULL));
+        } else if(z == 6) {
+            addr = MEMADDR();
+            set_reg(cpu, y, RD(addr), NULL);
+        } else {
+            set_reg(cpu, y, get_reg(cpu, z, xy), xy);
+        }
+        break;
+
+    case 2:
+        if(z == 6) {
+            addr = MEMADDR();
+            alu(cpu, y, RD(addr));
+        } else {
+            alu(cpu, y, get_reg(cpu, z, xy));
+        }
+        break;
+
+    default:
+        switch(z) {
+        case 0:
+            if(condition(cpu, y)) {
+                cpu->pc = pop(cpu);
+                cycles += 6;
+            }
+            break;
+        case 1:
+            if(q == 0) {
+                uint16_t v = pop(cpu);
+                if(p == 3) {
+                    SET_AF(v);
+                } else {
+                    set_rp(cpu, p, v, xy);
+                }
+            } else {
+                switch(p) {
+                    case 0: cpu->pc = pop(cpu); break;
+                    case 1: {
+                        uint8_t t;
+                        t = cpu->b; cpu->b = cpu->b_; cpu->b_ = t;
+                        t = cpu->c; cpu->c = cpu->c_; cpu->c_ = t;
+                        t = cpu->d; cpu->d = cpu->d_; cpu->d_ = t;
+                        t = cpu->e; cpu->e = cpu->e_; cpu->e_ = t;
+                        t = cpu->h; cpu->h = cpu->h_; cpu->h_ = t;
+                        t = cpu->l; cpu->l = cpu->l_; cpu->l_ = t;
+                        break;
+                    }
+                    case 2: cpu->pc = get_rp(cpu, 2, xy); break;
+                    default: cpu->sp = get_rp(cpu, 2, xy); break;
+                }
+            }
+            break;
+        case 2: {
+            uint16_t nn = fetch16(cpu);
+            if(condition(cpu, y)) {
+                cpu->pc = nn;
+            }
+            break;
+        }
+        case 3:
+            switch(y) {
+                case 0: cpu->pc = fetch16(cpu); break;
+                case 1: return exec_cb(cpu, xy) - (xy ? 4 : 0);
+                case 2: {
+                    uint8_t n = fetch(cpu);
+                    cpu->out(cpu->ctx, (uint16_t)((cpu->a << 8) | n), cpu->a);
+                    break;
+                }
+                case 3: {
+                    uint8_t n = fetch(cpu);
+                    cpu->a = cpu->in(cpu->ctx, (uint16_t)((cpu->a << 8) | n));
+                    break;
+                }
+                case 4: {
+                    uint16_t v = read16(cpu, cpu->sp);
+                    write16(cpu, cpu->sp, get_rp(cpu, 2, xy));
+                    set_rp(cpu, 2, v, xy);
+                    break;
+                }
+                case 5: {
+                    uint16_t t = DE;
+                    SET_DE(HL);
+                    SET_HL(t);
+                    break;
+                }
+                case 6: cpu->iff1 = cpu->iff2 = 0; break;
+                default: cpu->iff1 = cpu->iff2 = 1; cpu->ei_delay = 1; break;
+            }
+            break;
+        case 4: {
+            uint16_t nn = fetch16(cpu);
+            if(condition(cpu, y)) {
+                push(cpu, cpu->pc);
+                cpu->pc = nn;
+                cycles += 7;
+            }
+            break;
+        }
+        case 5:
+            if(q == 0) {
+                push(cpu, p == 3 ? AF : get_rp(cpu, p, xy));
+            } else {
+                switch(p) {
+                    case 0: {
+                        uint16_t nn = fetch16(cpu);
+                        push(cpu, cpu->pc);
+                        cpu->pc = nn;
+                        break;
+                    }
+                    case 1: inc_r(cpu); return 4 + exec_main(cpu, fetch(cpu), &cpu->ix);
+                    case 2: return exec_ed(cpu);
+                    default: inc_r(cpu); return 4 + exec_main(cpu, fetch(cpu), &cpu->iy);
+                }
+            }
+            break;
+        case 6:
+            alu(cpu, y, fetch(cpu));
+            break;
+        default:
+            push(cpu, cpu->pc);
+            cpu->pc = (uint16_t)(y * 8);
+            break;
+        }
+        break;
+    }
+
+    #undef MEMADDR
+    return cycles;
+}
+
+void cpu_reset(cpu_t *cpu) {
+    if(!tables_ready) {
+        init_tables();
+    }
+    cpu->a = cpu->f = 0xFF;
+    cpu->b = cpu->c = cpu->d = cpu->e = cpu->h = cpu->l = 0;
+    cpu->a_ = cpu->f_ = cpu->b_ = cpu->c_ = cpu->d_ = cpu->e_ = cpu->h_ = cpu->l_ = 0;
+    cpu->ix = cpu->iy = 0;
+    cpu->sp = 0xFFFF;
+    cpu->pc = 0;
+    cpu->i = cpu->r = 0;
+    cpu->iff1 = cpu->iff2 = cpu->im = 0;
+    cpu->halted = 0;
+    cpu->ei_delay = 0;
+    cpu->cycles = 0;
+}
+
+int cpu_step(cpu_t *cpu) {
+    int cycles;
+
+    cpu->ei_delay = 0;
+    inc_r(cpu);
+    if(cpu->halted) {
+        cycles = 4;     // HALT executes NOPs until an interrupt arrives
+    } else {
+        cycles = exec_main(cpu, fetch(cpu), NULL);
+    }
+    cpu->cycles += (uint64_t)cycles;
+    return cycles;
+}
+
+int cpu_interrupt(cpu_t *cpu) {
+    int cycles;
+
+    if(!cpu->iff1 || cpu->ei_delay) {
+        return 0;
+    }
+
+    cpu->halted = 0;
+    cpu->iff1 = cpu->iff2 = 0;
+    inc_r(cpu);
+    push(cpu, cpu->pc);
+
+    if(cpu->im == 2) {
+        cpu->pc = read16(cpu, (uint16_t)((cpu->i << 8) | 0xFF));
+        cycles = 19;
+    } else {
+        cpu->pc = 0x0038;   // IM 0 executes RST 38 from the floating bus
+        cycles = 13;
+    }
+
+    cpu->cycles += (uint64_t)cycles;
+    return cycles;
+}
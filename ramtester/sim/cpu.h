@@ -0,0 +1,81 @@
+/**************************************************************************
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   P2000T-RAMTESTER is free software:                                   *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   P2000T-RAMTESTER software is distributed in the hope that it will    *
+ *   be useful, but WITHOUT ANY WARRANTY; without even the implied        *
+ *   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#ifndef _CPU_H
+#define _CPU_H
+
+#include <stdint.h>
+
+// flag bits of the F register
+#define FLAG_C  0x01
+#define FLAG_N  0x02
+#define FLAG_P  0x04
+#define FLAG_X  0x08
+#define FLAG_H  0x10
+#define FLAG_Y  0x20
+#define FLAG_Z  0x40
+#define FLAG_S  0x80
+
+/*
+ * Z80 processor state; memory and I/O are accessed through the callbacks
+ * such that the machine model decides on the memory map and devices.
+ */
+typedef struct {
+    uint8_t a, f, b, c, d, e, h, l;
+    uint8_t a_, f_, b_, c_, d_, e_, h_, l_;   // alternate register set
+    uint16_t ix, iy, sp, pc;
+    uint8_t i, r;
+    uint8_t iff1, iff2, im;
+    uint8_t halted;
+    uint8_t ei_delay;                         // EI takes effect one instruction later
+    uint64_t cycles;                          // number of T-states executed
+
+    void *ctx;
+    uint8_t (*read)(void *ctx, uint16_t addr);
+    void (*write)(void *ctx, uint16_t addr, uint8_t val);
+    uint8_t (*in)(void *ctx, uint16_t port);
+    void (*out)(void *ctx, uint16_t port, uint8_t val);
+} cpu_t;
+
+/**
+ * @brief Reset the processor
+ *
+ * @param cpu processor state
+ */
+void cpu_reset(cpu_t *cpu);
+
+/**
+ * @brief Execute a single instruction
+ *
+ * @param cpu processor state
+ * @return number of T-states spent
+ */
+int cpu_step(cpu_t *cpu);
+
+/**
+ * @brief Raise a maskable interrupt; the data bus is assumed to read 0xFF
+ *        during the acknowledge cycle
+ *
+ * @param cpu processor state
+ * @return number of T-states spent, 0 when the interrupt was not accepted
+ */
+int cpu_interrupt(cpu_t *cpu);
+
+#endif // _CPU_H
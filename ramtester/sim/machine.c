@@ -0,0 +1,436 @@
+/**************************************************************************
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   P2000T-RAMTESTER is free software:                                   *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   P2000T-RAMTESTER software is distributed in the hope that it will    *
+ *   be useful, but WITHOUT ANY WARRANTY; without even the implied        *
+ *   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+/*
+ * P2000T memory map and RAM expansion board models.
+ *
+ *   0x0000 - 0x0FFF  monitor ROM (replaced by a minimal stub, see below)
+ *   0x1000 - 0x4FFF  cartridge ROM
+ *   0x5000 - 0x5FFF  video RAM
+ *   0x6000 - 0x9FFF  base RAM
+ *   0xA000 - 0xDFFF  expansion RAM, high memory
+ *   0xE000 - 0xFFFF  expansion RAM, bank window
+ *
+ * The 64, 128 and 512 KiB boards follow the decoding of the CPLD in
+ * pcb/p2000t-ram-expansion-board-128-512-smd-cpld/cupl: the 8 KiB bank at
+ * 0xA000 is RAM bank 1, the one at 0xC000 is RAM bank 0, and the bank window
+ * shows RAM bank S+2 where S is the value written to port 0x94, truncated to
+ * the width of the bank register. The two selectors beyond the last bank
+ * therefore shadow 0xC000 and 0xA000.
+ *
+ * Bit 7 of port 0x10 drives the serial (printer) output, which is decoded as
+ * 8N1 frames at SERIAL_BAUD by sampling the line in the middle of every bit.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "machine.h"
+
+// minimal replacement of the monitor: enable IM 1 interrupts, start the
+// cartridge and count video interrupts at 0x6010 like the monitor does
+static const uint8_t monitor_reset[] = {
+    0xF3,               // di
+    0x31, 0xFF, 0x9F,   // ld sp,0x9FFF
+    0xED, 0x56,         // im 1
+    0xFB,               // ei
+    0xC3, 0x10, 0x10,   // jp 0x1010
+};
+
+static const uint8_t monitor_isr[] = {
+    0xE5,               // push hl
+    0x2A, 0x10, 0x60,   // ld hl,(0x6010)
+    0x23,               // inc hl
+    0x22, 0x10, 0x60,   // ld (0x6010),hl
+    0xE1,               // pop hl
+    0xFB,               // ei
+    0xED, 0x4D,         // reti
+};
+
+static const uint8_t monitor_nmi[] = {
+    0xED, 0x45,         // retn
+};
+
+static uint8_t regbits(int board) {
+    switch(board) {
+        case BOARD_64:  return 3;
+        case BOARD_128: return 4;
+        default:        return 6;
+    }
+}
+
+/**
+ * Compute the expansion RAM offsets of the three 8 KiB windows for the given
+ * bank register values
+ */
+static void decode(machine_t *m, uint8_t reg94, uint8_t reg95, int32_t *window) {
+    uint32_t ebanks;
+    uint8_t hb;
+
+    switch(m->board) {
+        case BOARD_16:
+            window[0] = 0 * BANK_SIZE;
+            window[1] = 1 * BANK_SIZE;
+            window[2] = -1;     // nothing at 0xE000
+            return;
+        case BOARD_64:
+        case BOARD_128:
+        case BOARD_512: {
+            uint8_t mask = (uint8_t)((1 << regbits(m->board)) - 1);
+            window[0] = 1 * BANK_SIZE;
+            window[1] = 0 * BANK_SIZE;
+            window[2] = (int32_t)(((reg94 + 2) & mask) * BANK_SIZE);
+            if(m->board == BOARD_512 && (window[2] >> 17) >= m->chips) {
+                window[2] = -1; // chip not populated
+            }
+            return;
+        }
+        case BOARD_1056:
+            ebanks = 128;
+            hb = reg94 >> 7;
+            window[2] = (int32_t)((reg94 & 0x7F) * BANK_SIZE);
+            break;
+        case BOARD_2080:
+            ebanks = 256;
+            hb = reg95 & 0x01;
+            window[2] = (int32_t)(reg94 * BANK_SIZE);
+            break;
+        default:
+            window[0] = window[1] = window[2] = -1;
+            return;
+    }
+
+    window[0] = (int32_t)(ebanks * BANK_SIZE + hb * HIGHMEM_SIZE);
+    window[1] = window[0] + BANK_SIZE;
+}
+
+/**
+ * Apply address line faults to an expansion RAM offset
+ */
+static uint32_t ext_offset(machine_t *m, uint32_t off) {
+    off &= ~m->addrmask;
+    if(m->nrshorts) {
+        for(uint8_t i=0; i<m->nrfaults; i++) {
+            const fault_t *f = &m->faults[i];
+            if(f->type == FAULT_SHORT) {
+                uint32_t a = 1u << f->line_a, b = 1u << f->line_b;
+                if(!((off & a) && (off & b))) {
+                    off &= ~(a | b);
+                }
+            }
+        }
+    }
+    return off;
+}
+
+static uint8_t mem_read(void *ctx, uint16_t addr) {
+    machine_t *m = (machine_t*)ctx;
+
+    if(addr < VIDMEM_START) {
+        return m->rom[addr];
+    }
+    if(addr < BASEMEM_STOP) {
+        return m->base[addr - VIDMEM_START];
+    }
+
+    int32_t w = m->window[(addr >> 13) - 5];
+    if(w < 0) {
+        return 0xFF;    // floating data bus
+    }
+
+    uint32_t off = ext_offset(m, (uint32_t)w + (addr & (BANK_SIZE - 1)));
+    uint8_t v = m->ext[off];
+    for(uint8_t i=0; i<m->nrfaults; i++) {
+        const fault_t *f = &m->faults[i];
+        if(f->type == FAULT_STUCK && f->phys == off) {
+            v = (uint8_t)((v & ~f->mask) | (f->value & f->mask));
+        }
+    }
+    return v;
+}
+
+static void mem_write(void *ctx, uint16_t addr, uint8_t val) {
+    machine_t *m = (machine_t*)ctx;
+
+    if(addr < VIDMEM_START) {
+        return;         // ROM
+    }
+    if(addr < BASEMEM_STOP) {
+        m->base[addr - VIDMEM_START] = val;
+        if(addr == 0x600C && val == 0) {
+            m->key_wait = 1;
+        }
+        return;
+    }
+
+    int32_t w = m->window[(addr >> 13) - 5];
+    if(w >= 0) {
+        m->ext[ext_offset(m, (uint32_t)w + (addr & (BANK_SIZE - 1)))] = val;
+    }
+}
+
+static uint8_t io_in(void *ctx, uint16_t port) {
+    machine_t *m = (machine_t*)ctx;
+
+    if((port & 0xFF) == 0x94) {
+        switch(m->board) {
+            case BOARD_NONE:
+            case BOARD_16: return 0xFF;
+            case BOARD_1056:
+            case BOARD_2080: return m->reg94;
+            default: return (uint8_t)(m->reg94 & ((1 << regbits(m->board)) - 1));
+        }
+    }
+    return 0xFF;
+}
+
+/**
+ * Sample the serial line at the centre of every frame bit that has passed
+ * before a T-state, emitting completed bytes
+ */
+static void serial_advance(machine_t *m, uint64_t now) {
+    while(m->tx_bit >= 0) {
+        uint64_t t = m->tx_start + ((2 * m->tx_bit + 1) * (uint64_t)CLOCK_HZ) / (2 * SERIAL_BAUD);
+        if(t > now) {
+            return;
+        }
+        if(m->tx_bit == 0 && m->tx_level != 0) {
+            m->tx_bit = -1;     // glitch, not a start bit
+        } else if(m->tx_bit == 9) {
+            if(m->tx_level == 0) {
+                m->tx_errors++;
+            } else if(m->serial) {
+                fputc(m->tx_data, m->serial);
+                if(m->tx_data == '\n') {
+                    fflush(m->serial);
+                }
+            }
+            m->tx_bit = -1;
+        } else {
+            if(m->tx_bit > 0) {
+                m->tx_data = (uint8_t)((m->tx_data >> 1) | (m->tx_level << 7));
+            }
+            m->tx_bit++;
+        }
+    }
+}
+
+static void serial_write(machine_t *m, uint8_t level) {
+    uint64_t now = m->cpu.cycles;
+
+    serial_advance(m, now);
+    if(m->tx_bit < 0 && m->tx_level && !level) {
+        m->tx_bit = 0;
+        m->tx_start = now;
+    }
+    m->tx_level = level;
+}
+
+static void io_out(void *ctx, uint16_t port, uint8_t val) {
+    machine_t *m = (machine_t*)ctx;
+
+    switch(port & 0xFF) {
+        case 0x10: serial_write(m, val >> 7); return;
+        case 0x94: m->reg94 = val; break;
+        case 0x95: m->reg95 = val; break;
+        default: return;
+    }
+    decode(m, m->reg94, m->reg95, m->window);
+}
+
+/**
+ * @brief Initialize the machine with a board and an empty cartridge
+ *
+ * @param m     machine
+ * @param board board type
+ * @param chips number of populated 128 KiB chips (BOARD_512)
+ * @return 0 on success
+ */
+int machine_init(machine_t *m, int board, uint8_t chips) {
+    memset(m, 0, sizeof(machine_t));
+    m->board = board;
+    m->chips = chips;
+
+    switch(board) {
+        case BOARD_16:   m->extsize = 2 * BANK_SIZE; break;
+        case BOARD_64:   m->extsize = 8 * BANK_SIZE; break;
+        case BOARD_128:  m->extsize = 16 * BANK_SIZE; break;
+        case BOARD_512:  m->extsize = 64 * BANK_SIZE; break;
+        case BOARD_1056: m->extsize = 128 * BANK_SIZE + 2 * HIGHMEM_SIZE; break;
+        case BOARD_2080: m->extsize = 256 * BANK_SIZE + 2 * HIGHMEM_SIZE; break;
+        default:         m->extsize = 0; break;
+    }
+
+    if(m->extsize) {
+        m->ext = (uint8_t*)malloc(m->extsize);
+        if(!m->ext) {
+            return -1;
+        }
+        // power-up contents of static RAM are random; use a fixed pattern
+        for(uint32_t i=0; i<m->extsize; i++) {
+            m->ext[i] = (uint8_t)(i * 0x9D + (i >> 8));
+        }
+    }
+
+    memset(m->rom, 0xFF, sizeof(m->rom));
+    memcpy(&m->rom[0x0000], monitor_reset, sizeof(monitor_reset));
+    memcpy(&m->rom[0x0038], monitor_isr, sizeof(monitor_isr));
+    memcpy(&m->rom[0x0066], monitor_nmi, sizeof(monitor_nmi));
+
+    decode(m, 0, 0, m->window);
+
+    m->cpu.ctx = m;
+    m->cpu.read = mem_read;
+    m->cpu.write = mem_write;
+    m->cpu.in = io_in;
+    m->cpu.out = io_out;
+    cpu_reset(&m->cpu);
+    m->next_irq = FRAME_TSTATES;
+    m->tx_level = 1;
+    m->tx_bit = -1;
+    m->key = -1;
+
+    return 0;
+}
+
+/**
+ * @brief Release memory held by the machine
+ */
+void machine_free(machine_t *m) {
+    free(m->ext);
+    m->ext = NULL;
+}
+
+/**
+ * @brief Load a cartridge image at 0x1000
+ *
+ * @return 0 on success
+ */
+int machine_load_rom(machine_t *m, const char *filename) {
+    FILE *f = fopen(filename, "rb");
+    if(!f) {
+        return -1;
+    }
+    size_t n = fread(&m->rom[ROM_START], 1, ROM_SIZE, f);
+    fclose(f);
+    return n > 0 ? 0 : -1;
+}
+
+/**
+ * @brief Translate a bank selector and CPU address to an expansion RAM offset
+ *
+ * @return offset, or -1 when the address does not map onto expansion RAM
+ */
+int32_t machine_translate(machine_t *m, uint16_t selector, uint16_t addr) {
+    int32_t window[3];
+
+    if(addr < BASEMEM_STOP) {
+        return -1;
+    }
+    decode(m, (uint8_t)selector, (uint8_t)(selector >> 8), window);
+    int32_t w = window[(addr >> 13) - 5];
+    return w < 0 ? -1 : w + (addr & (BANK_SIZE - 1));
+}
+
+/**
+ * @brief Add a fault to the machine
+ *
+ * @return 0 on success, -1 when the fault does not fit the board
+ */
+int machine_add_fault(machine_t *m, const fault_t *fault) {
+    fault_t *f = &m->faults[m->nrfaults];
+
+    if(m->nrfaults == MAX_FAULTS) {
+        return -1;
+    }
+
+    *f = *fault;
+    switch(f->type) {
+        case FAULT_STUCK: {
+            int32_t phys = machine_translate(m, f->selector, f->addr);
+            if(phys < 0) {
+                return -1;
+            }
+            f->phys = (uint32_t)phys;
+            break;
+        }
+        case FAULT_SHORT:
+            if((1u << f->line_a) >= m->extsize || (1u << f->line_b) >= m->extsize) {
+                return -1;
+            }
+            m->nrshorts++;
+            break;
+        default:
+            if((1u << f->line_a) >= m->extsize) {
+                return -1;
+            }
+            m->addrmask |= 1u << f->line_a;
+            break;
+    }
+
+    m->nrfaults++;
+    return 0;
+}
+
+/**
+ * @brief Run until the program parks itself in an endless loop or until the
+ *        number of T-states is exceeded
+ *
+ * @return 1 when the program finished, 0 when the limit was reached
+ */
+int machine_run(machine_t *m, uint64_t max_tstates) {
+    cpu_t *cpu = &m->cpu;
+
+    while(cpu->cycles < max_tstates) {
+        // "jr $" marks the end of the program
+        if(!cpu->halted && mem_read(m, cpu->pc) == 0x18 &&
+           mem_read(m, (uint16_t)(cpu->pc + 1)) == 0xFE) {
+            serial_advance(m, UINT64_MAX);
+            return 1;
+        }
+        if(cpu->halted && !cpu->iff1) {
+            serial_advance(m, UINT64_MAX);
+            return 1;
+        }
+
+        cpu_step(cpu);
+
+        // the video interrupt remains pending until it is accepted
+        if(cpu->cycles >= m->next_irq) {
+            m->irq_pending = 1;
+            m->next_irq += FRAME_TSTATES;
+
+            // the key is pressed once, as soon as the program waits for a
+            // key by clearing the key buffer of the monitor, such that later
+            // prompts (e.g. the burn-in) time out
+            if(m->key >= 0 && m->key_wait && m->base[0x600C - VIDMEM_START] == 0) {
+                m->base[0x6000 - VIDMEM_START] = (uint8_t)m->key;
+                m->base[0x600C - VIDMEM_START] = 1;
+                m->key = -1;
+            }
+        }
+        if(m->irq_pending && cpu_interrupt(cpu)) {
+            m->irq_pending = 0;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,146 @@
+/**************************************************************************
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   P2000T-RAMTESTER is free software:                                   *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   P2000T-RAMTESTER software is distributed in the hope that it will    *
+ *   be useful, but WITHOUT ANY WARRANTY; without even the implied        *
+ *   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#ifndef _MACHINE_H
+#define _MACHINE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "cpu.h"
+
+#define CLOCK_HZ        2500000
+#define FRAME_TSTATES   (CLOCK_HZ / 50)     // video interrupt at 50 Hz
+
+#define ROM_START       0x1000              // cartridge slot 1
+#define ROM_SIZE        0x4000
+#define VIDMEM_START    0x5000
+#define BASEMEM_STOP    0xA000              // end of base memory
+
+#define BANK_SIZE       0x2000
+#define HIGHMEM_SIZE    0x4000
+#define MAX_FAULTS      16
+#define SERIAL_BAUD     9600                // serial output on bit 7 of port 0x10
+
+enum board_type {
+    BOARD_NONE,     // no expansion board
+    BOARD_16,       // 16 KiB at 0xA000-0xDFFF, no bank register
+    BOARD_64,       // 3-bit bank register, +2 decode
+    BOARD_128,      // 4-bit bank register, +2 decode
+    BOARD_512,      // 6-bit bank register, +2 decode, up to four 128 KiB chips
+    BOARD_1056,     // 7-bit bank register, bit 7 selects the 16 KiB high bank
+    BOARD_2080,     // 8-bit bank register, port 0x95 selects the 16 KiB high bank
+};
+
+enum fault_type {
+    FAULT_STUCK,    // data bit stuck at a value at a single location
+    FAULT_SHORT,    // two expansion RAM address lines shorted (wired AND)
+    FAULT_OPEN,     // expansion RAM address line stuck low
+};
+
+typedef struct {
+    uint8_t type;
+    uint16_t selector;  // bank selector and CPU address of the location (FAULT_STUCK)
+    uint16_t addr;
+    uint32_t phys;  // expansion RAM offset, resolved by machine_add_fault
+    uint8_t mask;   // affected data bits (FAULT_STUCK)
+    uint8_t value;  // value of the affected data bits (FAULT_STUCK)
+    uint8_t line_a; // address lines (FAULT_SHORT, FAULT_OPEN)
+    uint8_t line_b;
+} fault_t;
+
+typedef struct {
+    cpu_t cpu;
+
+    uint8_t rom[ROM_START + ROM_SIZE];      // monitor stub and cartridge
+    uint8_t base[BASEMEM_STOP - VIDMEM_START];
+
+    int board;
+    uint8_t chips;          // populated 128 KiB chips (BOARD_512)
+    uint8_t *ext;           // expansion RAM
+    uint32_t extsize;
+    int32_t window[3];      // expansion RAM offset of 0xA000, 0xC000, 0xE000; -1 when open
+    uint8_t reg94;
+    uint8_t reg95;
+
+    fault_t faults[MAX_FAULTS];
+    uint8_t nrfaults;
+    uint32_t addrmask;      // expansion RAM address lines forced low
+    uint8_t nrshorts;
+
+    uint8_t irq_pending;
+    uint64_t next_irq;
+
+    FILE *serial;           // receives the decoded serial output, NULL to discard
+    uint8_t tx_level;       // level of the serial line
+    int8_t tx_bit;          // frame bit being received, -1 when idle
+    uint8_t tx_data;
+    uint64_t tx_start;      // T-state of the falling edge of the start bit
+    uint32_t tx_errors;     // frames without stop bit
+
+    int key;                // key code to press, -1 for none
+    uint8_t key_wait;       // the program cleared the key buffer
+} machine_t;
+
+/**
+ * @brief Initialize the machine with a board and an empty cartridge
+ *
+ * @param m     machine
+ * @param board board type
+ * @param chips number of populated 128 KiB chips (BOARD_512)
+ * @return 0 on success
+ */
+int machine_init(machine_t *m, int board, uint8_t chips);
+
+/**
+ * @brief Release memory held by the machine
+ */
+void machine_free(machine_t *m);
+
+/**
+ * @brief Load a cartridge image at 0x1000
+ *
+ * @return 0 on success
+ */
+int machine_load_rom(machine_t *m, const char *filename);
+
+/**
+ * @brief Translate a bank selector and CPU address to an expansion RAM offset
+ *
+ * @return offset, or -1 when the address does not map onto expansion RAM
+ */
+int32_t machine_translate(machine_t *m, uint16_t selector, uint16_t addr);
+
+/**
+ * @brief Add a fault to the machine
+ *
+ * @return 0 on success, -1 when the fault does not fit the board
+ */
+int machine_add_fault(machine_t *m, const fault_t *fault);
+
+/**
+ * @brief Run until the program parks itself in an endless loop or until the
+ *        number of T-states is exceeded
+ *
+ * @return 1 when the program finished, 0 when the limit was reached
+ */
+int machine_run(machine_t *m, uint64_t max_tstates);
+
+#endif // _MACHINE_H
@@ -0,0 +1,243 @@
+/**************************************************************************
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   P2000T-RAMTESTER is free software:                                   *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   P2000T-RAMTESTER software is distributed in the hope that it will    *
+ *   be useful, but WITHOUT ANY WARRANTY; without even the implied        *
+ *   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+/*
+ * p2ksim: runs a RAM tester cartridge image on an emulated P2000T with one of
+ * the RAM expansion boards, optionally with injected faults, and prints the
+ * final screen together with the emulated runtime.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "machine.h"
+
+#define VIDMEM_ROWS     24
+#define VIDMEM_COLS     40
+#define VIDMEM_STRIDE   0x50
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+        "Usage: %s [options] RAMTEST.BIN\n"
+        "  -b BOARD             none, 16, 64, 128, 512, 1056 or 2080 (default: 2080)\n"
+        "  -c CHIPS             populated 128 KiB chips on the 512 KiB board (default: 4)\n"
+        "  -s SEL:ADDR:BIT:VAL  data bit stuck at VAL at ADDR when bank SEL is selected\n"
+        "  -x A:B               expansion RAM address lines A and B shorted\n"
+        "  -a LINE              expansion RAM address line LINE stuck low (aliasing)\n"
+        "  -t SECONDS           limit of emulated time (default: 3600)\n"
+        "  -d FILE              write video RAM (0x5000-0x5FFF) to FILE\n"
+        "  -S FILE              write the serial output to FILE, e.g. the pty of collect.py\n"
+        "  -k CODE              press the key with monitor key code CODE at the first prompt\n"
+        "  -q                   do not print the screen\n", prog);
+}
+
+static int parse_board(const char *s) {
+    static const struct { const char *name; int board; } boards[] = {
+        {"none", BOARD_NONE}, {"16", BOARD_16}, {"64", BOARD_64}, {"128", BOARD_128},
+        {"512", BOARD_512}, {"1056", BOARD_1056}, {"2080", BOARD_2080},
+    };
+    for(size_t i=0; i<sizeof(boards) / sizeof(boards[0]); i++) {
+        if(strcmp(s, boards[i].name) == 0) {
+            return boards[i].board;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Print the video RAM as text; control codes (colours, double height) are
+ * shown as spaces and graphic characters as '#'
+ */
+static void print_screen(const machine_t *m) {
+    const uint8_t *vid = &m->base[0];
+
+    printf("+----------------------------------------+\n");
+    for(int row=0; row<VIDMEM_ROWS; row++) {
+        char line[VIDMEM_COLS + 1];
+        for(int col=0; col<VIDMEM_COLS; col++) {
+            uint8_t c = vid[row * VIDMEM_STRIDE + col];
+            line[col] = (c < 0x20) ? ' ' : (c >= 0x7F ? '#' : (char)c);
+        }
+        line[VIDMEM_COLS] = 0;
+        printf("|%s|\n", line);
+    }
+    printf("+----------------------------------------+\n");
+}
+
+int main(int argc, char *argv[]) {
+    machine_t *m;
+    fault_t faults[MAX_FAULTS];
+    int nrfaults = 0;
+    int board = BOARD_2080;
+    int chips = 4;
+    double seconds = 3600.0;
+    const char *dumpfile = NULL;
+    const char *serialfile = NULL;
+    int key = -1;
+    int quiet = 0;
+    int opt;
+
+    while((opt = getopt(argc, argv, "b:c:s:x:a:t:d:S:k:qh")) != -1) {
+        fault_t *f = &faults[nrfaults];
+        int sel, addr;
+        unsigned bit, val, a, b;
+
+        if((opt == 's' || opt == 'x' || opt == 'a') && nrfaults == MAX_FAULTS) {
+            fprintf(stderr, "Too many faults, at most %d are supported\n", MAX_FAULTS);
+            return EXIT_FAILURE;
+        }
+
+        switch(opt) {
+            case 'b':
+                board = parse_board(optarg);
+                if(board < 0) {
+                    fprintf(stderr, "Unknown board: %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'c':
+                chips = atoi(optarg);
+                if(chips < 1 || chips > 4) {
+                    fprintf(stderr, "Number of chips should be between 1 and 4\n");
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 's':
+                if(sscanf(optarg, "%i:%i:%u:%u", &sel, &addr, &bit, &val) != 4 ||
+                   sel < 0 || sel > 0xFFFF || addr < 0 || addr > 0xFFFF || bit > 7 || val > 1) {
+                    fprintf(stderr, "Invalid stuck-at fault: %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                f->type = FAULT_STUCK;
+                f->selector = (uint16_t)sel;
+                f->addr = (uint16_t)addr;
+                f->mask = (uint8_t)(1 << bit);
+                f->value = (uint8_t)(val << bit);
+                nrfaults++;
+                break;
+            case 'x':
+                if(sscanf(optarg, "%u:%u", &a, &b) != 2 || a > 20 || b > 20 || a == b) {
+                    fprintf(stderr, "Invalid address short: %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                f->type = FAULT_SHORT;
+                f->line_a = (uint8_t)a;
+                f->line_b = (uint8_t)b;
+                nrfaults++;
+                break;
+            case 'a':
+                if(sscanf(optarg, "%u", &a) != 1 || a > 20) {
+                    fprintf(stderr, "Invalid address line: %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                f->type = FAULT_OPEN;
+                f->line_a = (uint8_t)a;
+                nrfaults++;
+                break;
+            case 't':
+                seconds = atof(optarg);
+                break;
+            case 'd':
+                dumpfile = optarg;
+                break;
+            case 'S':
+                serialfile = optarg;
+                break;
+            case 'k':
+                key = atoi(optarg);
+                break;
+            case 'q':
+                quiet = 1;
+                break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    if(optind != argc - 1) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    m = (machine_t*)malloc(sizeof(machine_t));
+    if(!m || machine_init(m, board, (uint8_t)chips) != 0) {
+        fprintf(stderr, "Cannot allocate memory\n");
+        return EXIT_FAILURE;
+    }
+
+    if(machine_load_rom(m, argv[optind]) != 0) {
+        fprintf(stderr, "Cannot read %s\n", argv[optind]);
+        return EXIT_FAILURE;
+    }
+
+    for(int i=0; i<nrfaults; i++) {
+        if(machine_add_fault(m, &faults[i]) != 0) {
+            fprintf(stderr, "Fault %d does not map onto expansion RAM of this board\n", i + 1);
+            return EXIT_FAILURE;
+        }
+    }
+
+    m->key = key;
+    if(serialfile) {
+        m->serial = fopen(serialfile, "wb");
+        if(!m->serial) {
+            fprintf(stderr, "Cannot open %s\n", serialfile);
+            return EXIT_FAILURE;
+        }
+    }
+
+    clock_t start = clock();
+    int finished = machine_run(m, (uint64_t)(seconds * CLOCK_HZ));
+    double wall = (double)(clock() - start) / CLOCKS_PER_SEC;
+    double emulated = (double)m->cpu.cycles / CLOCK_HZ;
+
+    if(!quiet) {
+        print_screen(m);
+    }
+
+    if(dumpfile) {
+        FILE *f = fopen(dumpfile, "wb");
+        if(!f || fwrite(&m->base[0], 1, 0x1000, f) != 0x1000) {
+            fprintf(stderr, "Cannot write %s\n", dumpfile);
+            return EXIT_FAILURE;
+        }
+        fclose(f);
+    }
+
+    printf("%s after %llu T-states: %.2f s emulated, %.2f s wall clock (%.0fx)\n",
+           finished ? "Finished" : "Time limit reached",
+           (unsigned long long)m->cpu.cycles, emulated, wall,
+           wall > 0 ? emulated / wall : 0.0);
+
+    if(m->tx_errors) {
+        printf("Serial output: %u framing error(s)\n", (unsigned)m->tx_errors);
+    }
+    if(m->serial) {
+        fclose(m->serial);
+    }
+
+    machine_free(m);
+    free(m);
+    return finished ? EXIT_SUCCESS : EXIT_FAILURE;
+}
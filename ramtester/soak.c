@@ -0,0 +1,254 @@
+/**************************************************************************
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   P2000T-RAMTESTER is free software:                                   *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   P2000T-RAMTESTER software is distributed in the hope that it will    *
+ *   be useful, but WITHOUT ANY WARRANTY; without even the implied        *
+ *   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#include "soak.h"
+
+// lower memory is only used by tests 4 and 9, see soak.h
+__at (LOWMEM) soak_row_t soak_table[SOAK_ROWS];
+
+// solid patterns of the first sweep, rotating from one pass to the next
+static const uint8_t soak_patterns[] = {0x55, 0xAA, 0x00, 0xFF};
+
+static uint16_t _soak_banks = 0;
+static uint8_t _soak_highbanks = 0;
+static bankaddr_t _soak_selector = 0;
+static uint16_t _soak_base = 0;         // seed of the random data, from the tick counter
+static uint16_t _soak_seq = 0;          // pass count for the data, keeps counting (and wraps)
+
+static uint16_t soak_seed(uint16_t pass, uint16_t row) { return _soak_base + pass * 0x1357 + row * 0x0101; }
+
+/**
+ * Add the errors of a row found in a pass to the table
+ */
+static void soak_record(uint16_t row, uint16_t pass, uint16_t errors) {
+    soak_row_t *r = &soak_table[row];
+    if(errors == 0) {
+        return;
+    }
+    r->errors = sat_add(r->errors, errors);
+    if(r->last != pass) {
+        if(r->first == 0) {
+            r->first = pass;
+        }
+        r->last = pass;
+        r->fails++;
+    }
+}
+
+/**
+ * Return whether a row that failed has passed before its first failure or
+ * in one of the passes since
+ */
+static uint8_t soak_intermittent(const soak_row_t *r, uint16_t pass) {
+    return r->first > 1 || r->fails != pass - r->first + 1;
+}
+
+/**
+ * Perform a single sweep over a region: verify the random data of the
+ * previous pass and write the solid pattern (sweep 1), or verify the solid
+ * pattern and write the random data of this pass (sweep 2)
+ */
+static uint16_t soak_region(char *region, uint8_t pages, uint16_t row, uint8_t bank,
+                            uint16_t pass, uint8_t sweep) {
+    uint8_t solid = soak_patterns[_soak_seq & 0x03];
+    uint16_t errors = 0;
+    if(sweep == 1) {
+        if(pass > 1) {
+            errors = count_lfsr_pattern(region, soak_seed(_soak_seq - 1, row), pages);
+        }
+        if(row < SOAK_HIGH) {
+            fill_bank_window(PATTERN16(solid));
+        } else {
+            fill_ram_bytes(region, solid, (uint16_t)pages << 8);
+        }
+    } else {
+        errors = fault_count_ram_bytes(region, solid, (uint16_t)pages << 8, bank);
+        fill_lfsr_pattern(region, soak_seed(_soak_seq, row), pages);
+    }
+    soak_record(row, pass, errors);
+    return errors;
+}
+
+/**
+ * Perform a single sweep over all high memory banks and 8 KiB banks; returns
+ * the number of errors
+ */
+static uint16_t soak_sweep(uint16_t pass, uint8_t sweep) {
+    uint16_t errors = 0;
+    for(uint8_t i=0; i<_soak_highbanks; i++) {
+        set_bank(i == 0 ? 0 : _soak_selector);
+        errors = sat_add(errors, soak_region(&memory[HIGHMEM_START], HIGHMEM_PAGES,
+                                             SOAK_HIGH + i, i, pass, sweep));
+    }
+    for(uint16_t i=0; i<_soak_banks; i++) {
+        set_bank(i);
+        uint16_t e = soak_region(&memory[BANKMEM_START], BANK_PAGES, i, (uint8_t)i, pass, sweep);
+        if(e != 0) {
+            bankgrid_set((uint8_t)i, BANKGRID_FAIL);
+        } else {
+            bankgrid_set((uint8_t)i, (sweep == 2 || pass > 1) ? BANKGRID_PASS : BANKGRID_WRITTEN);
+        }
+        errors = sat_add(errors, e);
+    }
+    set_bank(0);
+    return errors;
+}
+
+/**
+ * Write the name of a row, e.g. "BANK  17" or "HIGH   1"
+ */
+static void soak_write_row(uint16_t row) {
+    if(row >= SOAK_HIGH) {
+        fmt_str("HIGH ");
+        fmt_dec(row - SOAK_HIGH, 3);
+    } else {
+        fmt_str("BANK ");
+        fmt_dec(row, 3);
+    }
+}
+
+/**
+ * Print and export the result of a pass and announce the rows that failed
+ * for the first time
+ */
+static void soak_report(uint16_t pass, uint16_t ticks, uint32_t total, uint16_t errors) {
+    uint32_t secs = total / TICKS_PER_SECOND;
+    uint32_t rate = secs == 0 ? 0 : (uint32_t)pass * 3600 / secs;
+    if(rate > 0xFFFF) {
+        rate = 0xFFFF;
+    }
+
+    terminal_beginline();
+    fmt_str("  Pass ");
+    fmt_dec(pass, 5);
+    fmt_char(' ');
+    fmt_dec((uint16_t)(secs / 3600), 3);
+    fmt_char(':');
+    fmt_dec2((uint8_t)((secs / 60) % 60));
+    fmt_char(' ');
+    fmt_dec((uint16_t)rate, 4);
+    fmt_str("/h ");
+    if(errors == 0) {
+        fmt_color(COL_GREEN, "OK");
+    } else {
+        fmt_char(COL_RED);
+        fmt_dec(errors, 0);
+        fmt_str(" ERR");
+    }
+    terminal_newline();
+
+    serial_begin('I');
+    serial_field_dec(pass);
+    serial_field_dec(ticks);
+    serial_field_dec(errors);
+    serial_end();
+
+    for(uint16_t i=0; i<SOAK_ROWS; i++) {
+        const soak_row_t *r = &soak_table[i];
+        if(r->last != pass) {
+            continue;
+        }
+        if(r->first == pass) {
+            terminal_beginline();
+            fmt_str("  ");
+            soak_write_row(i);
+            fmt_color(COL_RED, " FIRST FAILURE");
+            terminal_newline();
+        }
+        serial_begin('K');
+        serial_field_hex16(i);
+        serial_field_dec(r->errors);
+        serial_field_dec(r->first);
+        serial_field_dec(r->fails);
+        serial_end();
+    }
+}
+
+/**
+ * Print the table of the rows that failed so far, marking intermittent
+ * faults with an asterisk
+ */
+static void soak_print_table(uint16_t pass) {
+    print_inline_color("  ROW      ERRORS FIRST FAILS", COL_CYAN);
+    uint8_t failed = 0;
+    for(uint16_t i=0; i<SOAK_ROWS; i++) {
+        const soak_row_t *r = &soak_table[i];
+        if(r->first == 0) {
+            continue;
+        }
+        failed = 1;
+        terminal_beginline();
+        fmt_str("  ");
+        soak_write_row(i);
+        fmt_char(' ');
+        fmt_dec(r->errors, 6);
+        fmt_char(' ');
+        fmt_dec(r->first, 5);
+        fmt_char(' ');
+        fmt_dec(r->fails, 5);
+        if(soak_intermittent(r, pass)) {
+            fmt_color(COL_YELLOW, "*");
+        }
+        terminal_newline();
+    }
+    if(!failed) {
+        print_inline_color("  No failures", COL_GREEN);
+    }
+}
+
+void soak_run(uint16_t nrbanks, uint8_t nrhighbanks, bankaddr_t highbank_selector) {
+    _soak_banks = nrbanks;
+    _soak_highbanks = nrhighbanks;
+    _soak_selector = highbank_selector;
+    _soak_base = get_ticks();
+    _soak_seq = 0;
+    memset(soak_table, 0x00, sizeof(soak_table));
+
+    print_inline_color("-= BURN-IN =-", COL_CYAN);
+    print_info("  Press a key for the table", 0);
+
+    // every sweep selects every bank once and returns to bank 0
+    uint16_t visits = 2 * (nrbanks + nrhighbanks + 1);
+    uint32_t total = 0;
+    keymem[0x0C] = 0;
+    for(uint16_t pass=1; ; pass += (pass != 0xFFFF)) {   // the last pass repeats
+        // the data follows _soak_seq, which does not stop at the last pass
+        _soak_seq++;
+        // a sweep takes well below the 21 minutes after which the tick
+        // counter wraps, hence the elapsed time is accumulated per sweep
+        progress_begin(SOAK_TEST, visits);
+        uint16_t start = get_ticks();
+        uint16_t errors = soak_sweep(pass, 1);
+        uint16_t mid = get_ticks();
+        errors = sat_add(errors, soak_sweep(pass, 2));
+        uint16_t first = mid - start;
+        uint16_t second = get_ticks() - mid;
+        progress_end();
+
+        total += first;
+        total += second;
+        soak_report(pass, sat_add(first, second), total, errors);
+
+        if(keymem[0x0C] != 0) {
+            keymem[0x0C] = 0;
+            soak_print_table(pass);
+        }
+    }
+}
@@ -0,0 +1,97 @@
+/**************************************************************************
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   P2000T-RAMTESTER is free software:                                   *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   P2000T-RAMTESTER software is distributed in the hope that it will    *
+ *   be useful, but WITHOUT ANY WARRANTY; without even the implied        *
+ *   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#ifndef _SOAK_H
+#define _SOAK_H
+
+#include <stdint.h>
+
+#include "constants.h"
+#include "memory.h"
+#include "terminal.h"
+#include "format.h"
+#include "util.h"
+#include "ramtest.h"
+#include "fill.h"
+#include "bankcounting.h"
+#include "bankgrid.h"
+#include "faultmap.h"
+#include "progress.h"
+#include "serial.h"
+
+/*
+ * The burn-in loops over all high memory banks and 8 KiB banks until the
+ * machine is switched off, to catch intermittent and thermal faults that a
+ * single pass misses. Every pass consists of two sweeps over the banks:
+ *
+ *   1. verify the random data of the previous pass, write a solid pattern
+ *   2. verify the solid pattern, write random data seeded by the pass
+ *
+ * Every byte is thus read back a full sweep after it has been written, and
+ * the solid pattern rotates over 0x55, 0xAA, 0x00 and 0xFF between passes.
+ * Errors count towards the pass that detects them. The pass number
+ * saturates at 65535, which an overnight run on a small board may reach:
+ * from then on every pass counts as pass 65535, such that errors still add
+ * up in the table while the number of failing passes stops growing and the
+ * passes per hour drop. The seeds and solid patterns follow a separate
+ * counter that keeps counting, such that every pass still verifies the data
+ * of the pass before.
+ *
+ * Per bank, the table keeps the cumulative number of errors, the pass of the
+ * first failure and the number of failing passes. A bank that passed before
+ * its first failure, or that passed again afterwards, is marked intermittent.
+ * A single line per pass is printed; the table of failing banks is printed
+ * when a key is pressed. The status line shows the progress of the pass as
+ * test 0 and is drawn from the interrupt handler (see progress.h), hence the
+ * sweeps only count their bank selections.
+ *
+ * The table (about 2 KiB) resides in lower memory at LOWMEM, which serves as
+ * test region of tests 4 and 9 only, such that it does not add to the data
+ * segment that must end below the interrupt vector table at ISR_TABLE.
+ *
+ * Every pass is exported as an I record, followed by a K record for every
+ * bank that failed in the pass (see serial.h).
+ */
+
+#define SOAK_TEST           0       // test number on the status line
+#define SOAK_TIMEOUT        (10 * TICKS_PER_SECOND)  // skip the burn-in when no key is pressed
+#define SOAK_MAX_BANKS      256     // 8 KiB banks
+#define SOAK_HIGH           SOAK_MAX_BANKS  // row of the first high memory bank
+#define SOAK_ROWS           (SOAK_MAX_BANKS + 2)
+
+typedef struct {
+    uint16_t errors;        // cumulative errors, saturates at 0xFFFF
+    uint16_t first;         // pass of the first failure, 0 when never failed
+    uint16_t last;          // pass of the last failure
+    uint16_t fails;         // number of failing passes
+} soak_row_t;
+
+extern soak_row_t soak_table[SOAK_ROWS];
+
+/**
+ * @brief Run the burn-in until the machine is switched off
+ *
+ * @param nrbanks           number of 8 KiB banks
+ * @param nrhighbanks       number of 16 KiB high memory banks
+ * @param highbank_selector selector of the second high memory bank
+ */
+void soak_run(uint16_t nrbanks, uint8_t nrhighbanks, bankaddr_t highbank_selector);
+
+#endif // _SOAK_H
@@ -26,5 +26,7 @@
 void write_stack_pointer(void) {
     uint16_t stackptr = get_stack_pointer();
     vidmem[0x50] = COL_MAGENTA;
-    sprintf(&vidmem[0x50+1], "Stack pointer: %04X", stackptr);
+    fmt_at(&vidmem[0x50+1]);
+    fmt_str("Stack pointer: ");
+    fmt_hex16(stackptr);
 }
\ No newline at end of file
@@ -22,10 +22,9 @@
 #define _STACK
 
 #include <stdint.h>
-#include <stdio.h>
-
 #include "constants.h"
 #include "memory.h"
+#include "format.h"
 
 uint16_t get_stack_pointer(void) __z88dk_callee;
 
@@ -25,46 +25,69 @@ uint8_t _terminal_maxlines = 0;
 uint8_t _terminal_startline = 0;
 uint8_t _terminal_endline = 0;
 uint16_t _prevcounter = 0;
-char termbuffer[LINELENGTH + TERMBUFFER_PADDING];
 
 void terminal_init(uint8_t start, uint8_t stop) {
     _terminal_startline = start;
     _terminal_curline = _terminal_startline;
     _terminal_maxlines = stop - start + 1;
     _terminal_endline = stop;
-    memset(termbuffer, 0x00, LINELENGTH);
 }
 
-void terminal_printtermbuffer(void) {
+/**
+ * @brief Move the last line of the terminal, keeping the most recent lines
+ *        on screen when the terminal shrinks
+ *
+ * @param stop new last line
+ */
+void terminal_resize(uint8_t stop) {
+    if(_terminal_curline > stop + 1) {
+        uint8_t shift = _terminal_curline - (stop + 1);
+        memcpy(&vidmem[LINESTRIDE * _terminal_startline],
+               &vidmem[LINESTRIDE * (_terminal_startline + shift)],
+               LINESTRIDE * (stop + 1 - _terminal_startline));
+        _terminal_curline -= shift;
+    }
+    _terminal_maxlines = stop - _terminal_startline + 1;
+    _terminal_endline = stop;
+}
+
+/**
+ * @brief Prepare the current line for output, scrolling the terminal when
+ *        the last line has been passed, and point the format cursor at it
+ *
+ * Text is composed directly in video memory using the fmt_* emitters; the
+ * line is finished by terminal_newline().
+ *
+ * @return char* start of the line in video memory
+ */
+char* terminal_beginline(void) {
     // scroll everything up when we are at the last line
     if(_terminal_curline > _terminal_endline) {
         terminal_scrollup();
         _terminal_curline--;
     }
 
-    // copy buffer to screen
-    memcpy(&vidmem[_terminal_curline * 0x50], termbuffer, LINELENGTH);
-    memset(termbuffer, 0x00, LINELENGTH);
+    char* line = &vidmem[_terminal_curline * LINESTRIDE];
+    memset(line, 0x00, LINELENGTH);
+    fmt_at(line);
 
-    // go to next line
-    _terminal_curline++;
+    return line;
 }
 
-void terminal_redoline(void) {
-    if(_terminal_curline > _terminal_endline) {
-        terminal_scrollup();
-        _terminal_curline--;
-    }
-
-    memcpy(&vidmem[_terminal_curline * 0x50], termbuffer, LINELENGTH);
-    memset(termbuffer, 0x00, LINELENGTH);
+void terminal_newline(void) {
+    _terminal_curline++;
 }
 
+/*
+ * The terminal lines are contiguous in video memory, hence the whole region
+ * is moved up by a single block copy (LDIR) rather than line by line. This
+ * also copies the invisible right half of every line, which is not used.
+ */
 void terminal_scrollup(void) {
-    for(uint8_t i=_terminal_startline; i<_terminal_endline; i++) {
-        memcpy(&vidmem[0x50*i], &vidmem[0x50*(i+1)], LINELENGTH);
-    }
-    memset(&vidmem[0x50*_terminal_endline], 0x00, LINELENGTH);
+    memcpy(&vidmem[LINESTRIDE * _terminal_startline],
+           &vidmem[LINESTRIDE * (_terminal_startline + 1)],
+           LINESTRIDE * (_terminal_endline - _terminal_startline));
+    memset(&vidmem[LINESTRIDE * _terminal_endline], 0x00, LINELENGTH);
 }
 
 void terminal_backup_line(void) {
@@ -72,19 +95,24 @@ void terminal_backup_line(void) {
 }
 
 void print_error(char* str) {
-    sprintf(termbuffer, "%cERROR%c%s", COL_RED, COL_WHITE, str);
-    terminal_printtermbuffer();
+    terminal_beginline();
+    fmt_color(COL_RED, "ERROR");
+    fmt_str(str);
+    terminal_newline();
 }
 
 void print_info(char* str, uint8_t backup_line) {
-    strncpy(termbuffer, str, LINELENGTH);
-    terminal_printtermbuffer();
-    if(backup_line == 1) {
-        terminal_backup_line();
+    terminal_beginline();
+    fmt_str(str);
+    if(backup_line != 1) {
+        terminal_newline();
     }
 }
 
 void print_inline_color(char* str, uint8_t color) {
-    sprintf(termbuffer, "  %c%s", color, str);
-    terminal_printtermbuffer();
-}
\ No newline at end of file
+    terminal_beginline();
+    fmt_str("  ");
+    fmt_char(color);
+    fmt_str(str);
+    terminal_newline();
+}
@@ -21,13 +21,13 @@
 #ifndef _TERMINAL_H
 #define _TERMINAL_H
 
-#include <stdio.h>
 #include <string.h>
 #include "memory.h"
 #include "constants.h"
+#include "format.h"
 
 #define LINELENGTH 40
-#define TERMBUFFER_PADDING 10
+#define LINESTRIDE 0x50 // distance between lines in video memory
 #define BLINK_INTERVAL 500 // ms
 #define TIMER_INTERVAL 20
 
@@ -38,11 +38,10 @@ extern uint8_t _terminal_startline;
 extern uint8_t _terminal_endline;
 extern uint16_t _prevcounter;
 
-extern char termbuffer[LINELENGTH + TERMBUFFER_PADDING]; // some additional padding for safety
-
 void terminal_init(uint8_t, uint8_t);
-void terminal_printtermbuffer(void);
-void terminal_redoline(void);
+void terminal_resize(uint8_t);
+char* terminal_beginline(void);
+void terminal_newline(void);
 void terminal_scrollup(void);
 void terminal_backup_line(void);
 
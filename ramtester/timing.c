@@ -0,0 +1,120 @@
+/**************************************************************************
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   P2000T-RAMTESTER is free software:                                   *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   P2000T-RAMTESTER software is distributed in the hope that it will    *
+ *   be useful, but WITHOUT ANY WARRANTY; without even the implied        *
+ *   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#include "timing.h"
+
+static uint8_t _timing_test = 0;
+static uint16_t _timing_last = 0;           // tick counter at the last sample
+static uint16_t _timing_done = 0;           // bitmask of tests that have run
+static uint32_t _timing_ticks[NR_TESTS];
+static uint32_t _timing_bytes[NR_TESTS];
+
+/**
+ * @brief Start timing a test
+ *
+ * @param test test number (1-NR_TESTS)
+ */
+void timing_begin(uint8_t test) {
+    _timing_test = test - 1;
+    _timing_ticks[_timing_test] = 0;
+    _timing_bytes[_timing_test] = 0;
+    _timing_last = get_ticks();
+}
+
+/**
+ * Add the ticks since the last sample to the current test; as long as the
+ * samples are less than 21 minutes apart, the tick counter cannot wrap in
+ * between
+ */
+static void timing_sample(void) {
+    uint16_t now = get_ticks();
+    _timing_ticks[_timing_test] += (uint16_t)(now - _timing_last);
+    _timing_last = now;
+}
+
+/**
+ * @brief Stop timing the current test and export its timing record
+ */
+void timing_end(void) {
+    timing_sample();
+    _timing_done |= (1 << _timing_test);
+
+    serial_begin('T');
+    serial_field_dec(_timing_test + 1);
+    serial_field_dec32(_timing_ticks[_timing_test]);
+    serial_field_dec((uint16_t)(_timing_bytes[_timing_test] >> 10));
+    serial_end();
+}
+
+/**
+ * @brief Account for bytes processed by the current test; every pass over a
+ *        region counts, irrespective of whether it reads, writes or both
+ *
+ * @param nrbytes number of bytes
+ */
+void timing_add_bytes(uint32_t nrbytes) {
+    timing_sample();
+    _timing_bytes[_timing_test] += nrbytes;
+}
+
+/**
+ * Write an elapsed number of ticks as " ssss.hhs" at the format cursor
+ */
+static void timing_write_seconds(uint32_t ticks) {
+    fmt_char(' ');
+    fmt_dec32(ticks / TICKS_PER_SECOND, 4);
+    fmt_char('.');
+    fmt_dec2((uint8_t)((ticks % TICKS_PER_SECOND) * (100 / TICKS_PER_SECOND)));
+    fmt_char('s');
+}
+
+/**
+ * @brief Print elapsed time and throughput for every test that has run
+ */
+void timing_report(void) {
+    uint32_t total = 0;
+
+    for(uint8_t i=0; i<NR_TESTS; i++) {
+        if(!(_timing_done & (1 << i))) {
+            continue;
+        }
+
+        uint32_t ticks = _timing_ticks[i];
+        total += ticks;
+
+        terminal_beginline();
+        fmt_str("  * TEST ");
+        fmt_dec(i+1, 0);
+        fmt_char(':');
+        timing_write_seconds(ticks);
+        if(_timing_bytes[i] != 0 && ticks != 0) {
+            uint16_t kibs = (uint16_t)((_timing_bytes[i] * TICKS_PER_SECOND) / (ticks * 1024));
+            fmt_char(' ');
+            fmt_dec(kibs, 5);
+            fmt_str(" KiB/s");
+        }
+        terminal_newline();
+    }
+
+    terminal_beginline();
+    fmt_str("  * TOTAL: ");
+    timing_write_seconds(total);
+    terminal_newline();
+}
@@ -0,0 +1,72 @@
+/**************************************************************************
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   P2000T-RAMTESTER is free software:                                   *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   P2000T-RAMTESTER software is distributed in the hope that it will    *
+ *   be useful, but WITHOUT ANY WARRANTY; without even the implied        *
+ *   warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#ifndef _TIMING_H
+#define _TIMING_H
+
+#include <stdint.h>
+
+#include "constants.h"
+#include "terminal.h"
+#include "util.h"
+#include "serial.h"
+
+#define NR_TESTS            16
+#define TICKS_PER_SECOND    (1000 / TIMER_INTERVAL)
+
+/*
+ * Elapsed time is sampled from the monitor's interrupt counter and therefore
+ * has a resolution of TIMER_INTERVAL ms. The only kernel that disables
+ * interrupts (fill_bank_window) enables them briefly after every KiB. A tick
+ * is only counted when the interrupt request is still pending by then, which
+ * holds in p2ksim but has not been verified on a P2000T; on hardware, up to
+ * one tick per call of fill_bank_window may be lost, such that tests that
+ * fill the bank window may be reported slightly too fast. The 16-bit counter
+ * wraps after about 21 minutes, hence the elapsed time of a test is
+ * accumulated in 32 bits every time the test accounts for the bytes of a
+ * bank (timing_add_bytes).
+ */
+
+/**
+ * @brief Start timing a test
+ *
+ * @param test test number (1-NR_TESTS)
+ */
+void timing_begin(uint8_t test);
+
+/**
+ * @brief Stop timing the current test and export its timing record
+ */
+void timing_end(void);
+
+/**
+ * @brief Account for bytes processed by the current test; every pass over a
+ *        region counts, irrespective of whether it reads, writes or both
+ *
+ * @param nrbytes number of bytes
+ */
+void timing_add_bytes(uint32_t nrbytes);
+
+/**
+ * @brief Print elapsed time and throughput for every test that has run
+ */
+void timing_report(void);
+
+#endif // _TIMING_H
@@ -3,38 +3,123 @@
 #
 # Requirements: pyserial and tqdm modules
 #
+# Usage: python upload.py [--port PORT]... [--all] [--bank BANK] [--window N] [--verify] [FILE]
+#
+# With --all, or when --port is given more than once, the image is flashed
+# onto several cartridges at once, using one worker thread per programmer.
+#
+# Only the 4 KiB sectors whose contents changed since the last upload are
+# erased and rewritten. The previous contents are taken from a manifest of
+# page hashes per programmer and bank (.upload_manifest.json), or read back
+# from the cartridge with --readback. When flashing several cartridges, the
+# manifest cannot tell a freshly inserted cartridge from the previous one,
+# hence every sector is rewritten unless --readback is given. With --verify,
+# the bank is read back even when no sector had to be rewritten.
+#
+# --readback and --verify rely on the RDBK command, which the stock programmer
+# firmware may not implement. A programmer that does not answer a command
+# within READ_TIMEOUT seconds fails the upload instead of blocking it.
+#
+# Blocks are pipelined: up to --window blocks are sent before their responses
+# are collected, such that the transfer is no longer bound by the round trip
+# per 256-byte block. Use --window 1 for the original stop-and-wait behaviour.
+#
+# The programmer is an ATmega32u4 with native USB; the baud rate set on the
+# serial port has no effect on the transfer speed.
+#
+
+import argparse
+import hashlib
+import json
+import os
+import sys
+import threading
+import time
+from collections import deque
 
-import numpy as np
 import serial
 import serial.tools.list_ports
 from tqdm import tqdm
 
+PAGE_SIZE = 256
+SECTOR_SIZE = 4 * 1024
+BANK_SIZE = 16 * 1024
+MANIFEST_FILE = '.upload_manifest.json'
+PAGES_PER_SECTOR = SECTOR_SIZE // PAGE_SIZE
+ERASED_PAGE = b'\xff' * PAGE_SIZE
+PROGRAMMER_VID = 0x2341
+PROGRAMMER_PID = 54
+READ_TIMEOUT = 5            # seconds, well above the erase time of a sector
+
+# serializes access to the manifest file from the worker threads
+manifest_lock = threading.Lock()
+
 def main():
-    ser = connect()
-    upload_rom(ser, 'main.rom', 3)
+    parser = argparse.ArgumentParser(description='Upload a ROM image to a development cartridge')
+    parser.add_argument('filename', nargs='?', default='main.rom',
+                        help='ROM image (default: main.rom)')
+    parser.add_argument('--port', action='append',
+                        help='serial port of the programmer, can be repeated (default: autodetect)')
+    parser.add_argument('--all', action='store_true',
+                        help='flash via all attached programmers')
+    parser.add_argument('--bank', type=int, default=3,
+                        help='16 KiB bank on the cartridge (default: 3)')
+    parser.add_argument('--window', type=int, default=8,
+                        help='number of blocks in flight (default: 8)')
+    parser.add_argument('--readback', action='store_true',
+                        help='compare against the cartridge contents instead of the manifest '
+                             '(requires RDBK support in the programmer firmware)')
+    parser.add_argument('--verify', action='store_true',
+                        help='read back and check every rewritten sector '
+                             '(requires RDBK support in the programmer firmware)')
+    parser.add_argument('--force', action='store_true',
+                        help='rewrite all sectors of the bank')
+    args = parser.parse_args()
+
+    ports = args.port or []
+    if args.all:
+        ports += [p for p in find_programmers() if p not in ports]
+        if not ports:
+            raise Exception('No programmer found.')
+
+    if len(ports) > 1:
+        ok = upload_parallel(ports, args.filename, args.bank, args.window, args.readback,
+                             args.verify, args.force)
+        sys.exit(0 if ok else 1)
+
+    ser = connect(ports[0] if ports else None)
+    upload_rom(ser, args.filename, args.bank, args.window, args.readback, args.verify,
+               args.force)
     ser.close()
 
-def connect():
+def find_programmers():
+    """
+    Return the serial ports of all attached programmers
+    """
+    return sorted(p.device for p in serial.tools.list_ports.comports()
+                  if p.vid == PROGRAMMER_VID and p.pid == PROGRAMMER_PID)
+
+def connect(port=None):
     # autofind any available boards
-    ports = serial.tools.list_ports.comports()
-    portfound = None
-    for port in ports:
-        if port.pid == 54 and port.vid == 0x2341:
-            portfound = port.device
-            break
-
-    # specify the COM port below
-    if portfound:
-        ser = serial.Serial(portfound, 
-                            19200, 
-                            bytesize=serial.EIGHTBITS,
-                            parity=serial.PARITY_NONE,
-                            stopbits=serial.STOPBITS_ONE,
-                            timeout=None)  # open serial port
-                   
-        if not ser.isOpen():
-            ser.open()
-    
+    portfound = port
+    if portfound is None:
+        ports = find_programmers()
+        if ports:
+            portfound = ports[0]
+
+    if portfound is None:
+        raise Exception('No programmer found.')
+
+    ser = serial.Serial(portfound,
+                        19200,
+                        bytesize=serial.EIGHTBITS,
+                        parity=serial.PARITY_NONE,
+                        stopbits=serial.STOPBITS_ONE,
+                        timeout=READ_TIMEOUT)  # open serial port
+
+    if not ser.isOpen():
+        ser.open()
+
     return ser
 
 def test_board_id(ser):
@@ -46,15 +131,124 @@ def test_board_id(ser):
     print(res)
     res = ser.read(16)
     print(res)
-    
+
     if res == b'Ph2k-32u4-v1.0.3':
         print('Connection established. All ok!')
     else:
         raise Exception('Cannot connect. Invalid response.')
 
-def upload_rom(ser, filename, bank=0):
+def pipeline(ser, requests, window, rsplen, desc=None):
+    """
+    Send requests while keeping at most window requests in flight and return
+    the responses in order. Every request is a bytes object; every response
+    is rsplen bytes long.
+    """
+    responses = []
+    inflight = deque()
+
+    def collect():
+        req = inflight.popleft()
+        rsp = ser.read(rsplen)
+        if len(rsp) != rsplen:
+            raise Exception('No response to %s within %i s; is it supported by the firmware?' %
+                            (req[:8].decode('ascii', 'replace'), READ_TIMEOUT))
+        responses.append(rsp)
+
+    for req in tqdm(requests, desc=desc, disable=desc is None):
+        ser.write(req)
+        inflight.append(req)
+        if len(inflight) >= window:
+            collect()
+    while inflight:
+        collect()
+    return responses
+
+def erase_sectors(ser, sectors, window, desc='Erasing'):
+    """
+    Erase 4 KiB sectors, identified by their absolute sector number
+    """
+    pipeline(ser, [b'ESST00%02X' % (s * 0x10) for s in sectors], window, 8 + 2,
+             desc=desc)
+
+def write_pages(ser, pages, window, desc='Writing'):
+    """
+    Write 256-byte pages, given as (absolute page number, data) tuples; the
+    1-byte checksum returned per page is discarded.
+    """
+    pipeline(ser, [b'WRBK%04X' % p + bytes(data) for p, data in pages], window,
+             8 + 1, desc=desc)
+
+def read_pages(ser, pages, window, desc='Reading'):
+    """
+    Read back 256-byte pages identified by their absolute page number
+    """
+    rsp = pipeline(ser, [b'RDBK%04X' % p for p in pages], window, 8 + PAGE_SIZE,
+                   desc=desc)
+    return [r[8:] for r in rsp]
+
+def load_manifest():
+    if os.path.exists(MANIFEST_FILE):
+        with open(MANIFEST_FILE) as f:
+            return json.load(f)
+    return {}
+
+def store_manifest(manifest):
+    with open(MANIFEST_FILE, 'w') as f:
+        json.dump(manifest, f, indent=2)
+
+def update_manifest(key, hashes):
+    """
+    Store the page hashes for a single key, or drop the key when hashes is
+    None, leaving the entries of other programmers intact
+    """
+    with manifest_lock:
+        manifest = load_manifest()
+        if hashes is None:
+            manifest.pop(key, None)
+        else:
+            manifest[key] = hashes
+        store_manifest(manifest)
+
+def manifest_key(ser, bank):
+    return '%s:%i' % (ser.port, bank)
+
+def page_hash(data):
+    return hashlib.sha1(bytes(data)).hexdigest()
+
+def verify_sectors(ser, image, sectors, offset, window, progress=True):
+    """
+    Read back sectors, given relative to the bank, and compare a hash of
+    every sector against the image
+    """
+    pages = [offset + s * PAGES_PER_SECTOR + i for s in sectors for i in range(PAGES_PER_SECTOR)]
+    data = read_pages(ser, pages, window, 'Reading' if progress else None)
+    failed = []
+    for j, s in enumerate(sectors):
+        current = b''.join(data[j * PAGES_PER_SECTOR:(j + 1) * PAGES_PER_SECTOR])
+        expected = image[s * SECTOR_SIZE:(s + 1) * SECTOR_SIZE]
+        if hashlib.sha256(current).digest() != hashlib.sha256(expected).digest():
+            failed.append(s)
+    return failed
+
+def verify_bank(ser, image, sectors, offset, window, log=print, progress=True):
+    """
+    Verify sectors, given relative to the bank, raising an exception when any
+    of them differs from the image; returns the number of bytes read
+    """
+    failed = verify_sectors(ser, image, sectors, offset, window, progress)
+    if failed:
+        raise Exception('Verification failed for sector(s) %s.' %
+                        ', '.join(str(s) for s in failed))
+    log('Verified %i sectors' % len(sectors))
+    return len(sectors) * SECTOR_SIZE
+
+def upload_rom(ser, filename, bank=0, window=8, readback=False, verify=False, force=False,
+               log=print, progress=True):
     """
     Upload the ROM file
+
+    Returns a dictionary with the number of bytes transferred and whether the
+    rewritten sectors were verified (None when not requested)
     """
     # check that a connection to the board can be established
     ser.write(b'DEVIDSST')
@@ -62,33 +256,128 @@ def upload_rom(ser, filename, bank=0):
     rsp = ser.read(2)
     if rsp != bytearray([0xBF,0xB7]):
         raise Exception("Incorrect chip id.")
-        
+
     f = open(filename, 'rb')
     data = bytearray(f.read())
     f.close()
-    
-    # wipe second bank
-    print('Wiping bank %i' % bank)
-    for i in tqdm(range(0,4)):
-        ser.write(b'ESST00%02X' % ((i+bank*4) * 0x10))
-        res = ser.read(8)
-        res = ser.read(2)
-
-    # expand data to first 256 byte increment
+
+    if len(data) > BANK_SIZE:
+        raise Exception('Image exceeds %i bytes.' % BANK_SIZE)
+
+    # expand data to first 256 byte increment; the remainder of the bank is
+    # left erased
     sz = len(data)
-    exp = (sz // 256 + 1) * 256
-    data.extend(np.zeros(exp - sz))
-    
-    offset = bank * 16 * 1024 // 256
-
-    print('Writing data to bank %i' % bank)
-    for i in tqdm(range(0, exp // 256)):
-        ser.write(b'WRBK%04X' % (i + offset))
-        res = ser.read(8)
-        parcel = data[i*256:(i+1)*256]
-        ser.write(parcel)
-        checksum = np.uint8(ser.read(1)[0])
-        
-        
+    exp = min((sz // 256 + 1) * 256, BANK_SIZE)
+    data.extend(bytes(exp - sz))
+    data.extend(ERASED_PAGE * ((BANK_SIZE - exp) // PAGE_SIZE))
+
+    offset = bank * BANK_SIZE // PAGE_SIZE
+    npages = BANK_SIZE // PAGE_SIZE
+    nsectors = BANK_SIZE // SECTOR_SIZE
+    hashes = [page_hash(data[i*256:(i+1)*256]) for i in range(npages)]
+
+    result = {'bytes': 0, 'verified': None}
+
+    # determine the current contents of the bank
+    key = manifest_key(ser, bank)
+    if force:
+        current = None
+    elif readback:
+        current = [page_hash(p) for p in read_pages(ser, range(offset, offset + npages), window,
+                                                   'Reading' if progress else None)]
+        result['bytes'] += BANK_SIZE
+    else:
+        with manifest_lock:
+            current = load_manifest().get(key)
+
+    sectors = [s for s in range(nsectors)
+               if current is None or
+               current[s * PAGES_PER_SECTOR:(s + 1) * PAGES_PER_SECTOR] !=
+               hashes[s * PAGES_PER_SECTOR:(s + 1) * PAGES_PER_SECTOR]]
+    if not sectors:
+        log('Bank %i already holds %s; nothing to do' % (bank, filename))
+        if verify:
+            result['bytes'] += verify_bank(ser, data, range(nsectors), offset, window, log, progress)
+            result['verified'] = True
+        return result
+
+    # the manifest is invalid until the upload has completed
+    update_manifest(key, None)
+
+    log('Erasing %i of %i sectors in bank %i' % (len(sectors), nsectors, bank))
+    erase_sectors(ser, [bank * nsectors + s for s in sectors], window,
+                  'Erasing' if progress else None)
+
+    # erased pages read 0xFF and do not need to be written
+    pages = [s * PAGES_PER_SECTOR + i for s in sectors for i in range(PAGES_PER_SECTOR)]
+    pages = [(offset + p, data[p*256:(p+1)*256]) for p in pages
+             if data[p*256:(p+1)*256] != ERASED_PAGE]
+
+    log('Writing %i pages to bank %i' % (len(pages), bank))
+    write_pages(ser, pages, window, 'Writing' if progress else None)
+    result['bytes'] += len(pages) * PAGE_SIZE
+
+    if verify:
+        result['bytes'] += verify_bank(ser, data, sectors, offset, window, log, progress)
+        result['verified'] = True
+
+    update_manifest(key, hashes)
+    return result
+
+def upload_parallel(ports, filename, bank=0, window=8, readback=False, verify=False,
+                    force=False):
+    """
+    Upload the ROM file via several programmers at once, one worker thread
+    per serial port, and print a summary per programmer. The manifest is kept
+    per programmer, while cartridges are swapped between batches, hence the
+    manifest is not trusted: every sector is rewritten, or only the changed
+    ones when the cartridges are read back.
+
+    Returns True when all uploads succeeded
+    """
+    results = {}
+    lock = threading.Lock()
+
+    def log(port, msg):
+        with lock:
+            print('%s: %s' % (port, msg), flush=True)
+
+    def worker(port):
+        start = time.monotonic()
+        res = {'bytes': 0, 'verified': None, 'error': None}
+        try:
+            ser = connect(port)
+            try:
+                res.update(upload_rom(ser, filename, bank, window, readback, verify,
+                                      force or not readback,
+                                      log=lambda msg: log(port, msg), progress=False))
+            finally:
+                ser.close()
+        except Exception as e:
+            res['error'] = str(e)
+            log(port, 'ERROR: %s' % e)
+        res['time'] = time.monotonic() - start
+        results[port] = res
+
+    threads = [threading.Thread(target=worker, args=(p,)) for p in ports]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+
+    print('%-20s %8s %8s %10s  %s' % ('PORT', 'BYTES', 'TIME', 'KiB/s', 'STATUS'))
+    for port in ports:
+        res = results[port]
+        rate = res['bytes'] / 1024 / res['time'] if res['time'] > 0 else 0.0
+        if res['error'] is not None:
+            status = 'FAILED'
+        elif res['verified'] is None:
+            status = 'ok (not verified)'
+        else:
+            status = 'ok (verified)'
+        print('%-20s %8i %7.2fs %10.1f  %s' % (port, res['bytes'], res['time'], rate, status))
+
+    return all(r['error'] is None for r in results.values())
+
 if __name__ == '__main__':
     main()
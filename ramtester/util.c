@@ -20,6 +20,22 @@ void wait_for_key(void) {
     while(keymem[0x0C] == 0) {} // wait until a key is pressed
 }
 
+/**
+ * @brief Wait for a key-press during at most a number of ticks
+ *
+ * @return uint8_t 1 when a key was pressed, the key code is found at keymem[0]
+ */
+uint8_t wait_for_key_ticks(uint16_t ticks) {
+    uint16_t start = get_ticks();
+    keymem[0x0C] = 0;
+    while(keymem[0x0C] == 0) {
+        if(get_ticks() - start >= ticks) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
 /**
  * @brief Wait but check for a specific key press
  *
@@ -35,4 +51,34 @@ uint8_t wait_for_key_fixed(uint8_t quitkey) {
 
 void clear_screen(void) {
     memset(vidmem, 0x00, 0x1000);
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Read the interrupt counter maintained by the monitor, which is
+ *        incremented every TIMER_INTERVAL ms
+ *
+ * @return uint16_t number of ticks
+ */
+uint16_t get_ticks(void) {
+    volatile uint8_t *counter = (volatile uint8_t*)&keymem[0x10];
+
+    // the interrupt handler may increment the counter between the reads of
+    // its two bytes, hence read it until two reads agree
+    uint16_t ticks;
+    do {
+        ticks = counter[0] | (counter[1] << 8);
+    } while(ticks != (uint16_t)(counter[0] | (counter[1] << 8)));
+    return ticks;
+}
+
+/**
+ * @brief Add two counters, saturating at 0xFFFF instead of wrapping
+ *
+ * @return uint16_t sum, at most 0xFFFF
+ */
+uint16_t sat_add(uint16_t a, uint16_t b) {
+    if(a > 0xFFFF - b) {
+        return 0xFFFF;
+    }
+    return a + b;
+}
@@ -7,6 +7,9 @@ uint16_t read_uint16_t(const uint8_t* data);
 uint32_t read_uint32_t(const uint8_t* data);
 void wait_for_key(void);
 uint8_t wait_for_key_fixed(uint8_t quitkey);
+uint8_t wait_for_key_ticks(uint16_t ticks);
 void clear_screen(void);
+uint16_t get_ticks(void);
+uint16_t sat_add(uint16_t a, uint16_t b);
 
 #endif //_UINT_UTIL_H
\ No newline at end of file